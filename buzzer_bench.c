@@ -0,0 +1,228 @@
+// 부저 타이밍 정확도 벤치마크 (pwm_mock 모듈 필요)
+//
+//   insmod pwm_mock.ko [log_len=N] # dmesg에 나오는 pwm_index 확인
+//   insmod safe_buzzer.ko pwm_index=N [use_hrtimer=0]
+//   gcc -O2 -o buzzer_bench buzzer_bench.c
+//   sudo ./buzzer_bench -n 2000 -m seq -s 4
+//
+// 요청 시각(CLOCK_MONOTONIC)과 pwm_mock이 기록한 apply 시각(ktime)을 맞춰
+// 시작 지연, 음 길이 오차, 음 시작 시각 누적 오차의 p50/p99/max를 출력한다.
+// pwm_mock 기록이 넘쳐 버려진 apply가 있으면 매칭이 어긋나므로 실패(종료 코드 1)로 처리.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+
+#define BUZ_DEV   "/dev/safe_buzzer"
+#define MOCK_LOG  "/sys/kernel/debug/pwm_mock/log"
+#define MOCK_CLR  "/sys/kernel/debug/pwm_mock/clear"
+#define MOCK_LOST "/sys/kernel/debug/pwm_mock/lost"
+
+struct buz_note {
+    unsigned short freq_hz;
+    unsigned char  duty_pct;
+    unsigned char  rsvd;
+    unsigned short dur_ms;
+    unsigned short gap_ms;
+};
+#define BUZ_IOC_WAIT _IO('b', 0)
+
+#define MAX_NOTES 4
+#define MAX_STRESS 64
+
+struct trial {
+    long long t_req;
+    int count;
+    struct buz_note notes[MAX_NOTES];
+};
+
+struct evt {
+    long long ts;
+    int enabled;
+};
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int cmp_ll(const void *a, const void *b)
+{
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+// 절대값 기준 분포 (us)
+static void report(const char *name, long long *v, int n)
+{
+    long long sum = 0;
+
+    if (n == 0) {
+        printf("%-14s (no samples)\n", name);
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        sum += v[i];
+        if (v[i] < 0) v[i] = -v[i];
+    }
+    qsort(v, n, sizeof(*v), cmp_ll);
+    printf("%-14s n=%-6d mean=%+8.1f  p50=%8.1f  p99=%8.1f  max=%8.1f us\n", name, n,
+           sum / (double)n / 1000.0, v[n / 2] / 1000.0, v[(n * 99) / 100] / 1000.0,
+           v[n - 1] / 1000.0);
+}
+
+static long read_long(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    long v = -1;
+
+    if (!fp) { perror(path); return -1; }
+    if (fscanf(fp, "%ld", &v) != 1) v = -1;
+    fclose(fp);
+    return v;
+}
+
+static void write_str(const char *path, const char *s)
+{
+    int fd = open(path, O_WRONLY);
+    if (fd < 0) { perror(path); exit(1); }
+    write(fd, s, strlen(s));
+    close(fd);
+}
+
+int main(int argc, char **argv)
+{
+    int n = 1000, n_stress = 0, seq_mode = 0, opt;
+    long lost;
+    pid_t stress[MAX_STRESS];
+    struct trial *tr;
+    struct evt *ev;
+    int n_ev = 0, cap_ev = 4096;
+    long long *lat, *dur, *onset;
+    int n_lat = 0, n_dur = 0, n_onset = 0, unmatched = 0;
+    long long ts, period, duty;
+    int enabled;
+    FILE *fp;
+    int fd;
+
+    while ((opt = getopt(argc, argv, "n:m:s:")) != -1) {
+        if (opt == 'n') n = atoi(optarg);
+        else if (opt == 'm') seq_mode = !strcmp(optarg, "seq");
+        else if (opt == 's') n_stress = atoi(optarg);
+        else {
+            fprintf(stderr, "usage: %s [-n trials] [-m beep|seq] [-s stress_workers]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (n_stress > MAX_STRESS) n_stress = MAX_STRESS;
+
+    fd = open(BUZ_DEV, O_WRONLY);
+    if (fd < 0) { perror("Buzzer open fail"); return 1; }
+
+    tr = calloc(n, sizeof(*tr));
+    lat = calloc(n, sizeof(*lat));
+    dur = calloc(n * MAX_NOTES, sizeof(*dur));
+    onset = calloc(n * MAX_NOTES, sizeof(*onset));
+    ev = malloc(cap_ev * sizeof(*ev));
+    if (!tr || !lat || !dur || !onset || !ev) { perror("alloc"); return 1; }
+
+    write_str(MOCK_CLR, "1");
+
+    // CPU 부하: 단순 바쁜 루프 프로세스
+    for (int i = 0; i < n_stress; i++) {
+        stress[i] = fork();
+        if (stress[i] == 0) for (;;) ;
+    }
+
+    srand(1);
+    for (int i = 0; i < n; i++) {
+        struct trial *t = &tr[i];
+
+        if (seq_mode) {
+            // 음마다 주파수를 달리해 PWM 코어가 같은 상태라고 건너뛰지 않게 함
+            t->count = MAX_NOTES;
+            for (int k = 0; k < MAX_NOTES; k++) {
+                t->notes[k].freq_hz = 800 + k * 200;
+                t->notes[k].dur_ms = 10 + rand() % 31;
+                t->notes[k].gap_ms = 5 + rand() % 16;
+            }
+            t->t_req = now_ns();
+            write(fd, t->notes, t->count * sizeof(struct buz_note));
+        } else {
+            int ms = 5 + rand() % 46;
+            t->count = 1;
+            t->notes[0].dur_ms = ms;
+            t->t_req = now_ns();
+            write(fd, &ms, sizeof(ms));
+        }
+        ioctl(fd, BUZ_IOC_WAIT);
+        usleep(2000 + rand() % 3000);
+    }
+
+    for (int i = 0; i < n_stress; i++) kill(stress[i], SIGKILL);
+    for (int i = 0; i < n_stress; i++) waitpid(stress[i], NULL, 0);
+
+    lost = read_long(MOCK_LOST);
+    fp = fopen(MOCK_LOG, "r");
+    if (!fp) { perror(MOCK_LOG); return 1; }
+    while (fscanf(fp, "%lld %d %lld %lld", &ts, &enabled, &period, &duty) == 4) {
+        if (n_ev == cap_ev) {
+            cap_ev *= 2;
+            ev = realloc(ev, cap_ev * sizeof(*ev));
+            if (!ev) { perror("alloc"); return 1; }
+        }
+        ev[n_ev].ts = ts;
+        ev[n_ev].enabled = enabled;
+        n_ev++;
+    }
+    fclose(fp);
+
+    // 요청 순서대로 apply 기록을 따라가며 매칭
+    for (int i = 0, j = 0; i < n; i++) {
+        struct trial *t = &tr[i];
+        long long ideal = 0;
+
+        while (j < n_ev && ev[j].ts < t->t_req) j++;
+        for (int k = 0; k < t->count; k++) {
+            long long on, end;
+
+            while (j < n_ev && !ev[j].enabled) j++;
+            if (j + 1 >= n_ev) { unmatched++; break; }
+            on = ev[j].ts;
+            end = ev[j + 1].ts;
+            j++;
+
+            if (k == 0) {
+                ideal = on;
+                lat[n_lat++] = on - t->t_req;
+            } else {
+                onset[n_onset++] = on - ideal;
+            }
+            dur[n_dur++] = (end - on) - t->notes[k].dur_ms * 1000000LL;
+            ideal += (t->notes[k].dur_ms + t->notes[k].gap_ms) * 1000000LL;
+        }
+    }
+
+    printf("mode=%s trials=%d stress=%d events=%d unmatched=%d\n",
+           seq_mode ? "seq" : "beep", n, n_stress, n_ev, unmatched);
+    report("start_latency", lat, n_lat);
+    report("duration_err", dur, n_dur);
+    if (seq_mode) report("onset_drift", onset, n_onset);
+
+    close(fd);
+    if (lost < 0)
+        fprintf(stderr, "warning: can't read %s, results may be incomplete\n", MOCK_LOST);
+    if (lost > 0) {
+        fprintf(stderr, "pwm_mock dropped %ld events (log full): reload pwm_mock with a "
+                "larger log_len or lower -n; results above are not valid\n", lost);
+        return 1;
+    }
+    return 0;
+}
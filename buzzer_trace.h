@@ -0,0 +1,44 @@
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM safe_buzzer
+
+#if !defined(BUZZER_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define BUZZER_TRACE_H
+
+#include <linux/tracepoint.h>
+
+// 시퀀스 재생 시작 (선점/대기열에서 이어 재생 포함)
+TRACE_EVENT(buzzer_start,
+    TP_PROTO(u8 prio, int notes, u16 freq_hz),
+    TP_ARGS(prio, notes, freq_hz),
+    TP_STRUCT__entry(
+        __field(u8, prio)
+        __field(int, notes)
+        __field(u16, freq_hz)
+    ),
+    TP_fast_assign(
+        __entry->prio = prio;
+        __entry->notes = notes;
+        __entry->freq_hz = freq_hz;
+    ),
+    TP_printk("prio=%u notes=%d first_hz=%u", __entry->prio, __entry->notes, __entry->freq_hz)
+);
+
+// 재생 종료 (stopped=1 이면 write(0)/ioctl 등으로 중간에 멈춤)
+TRACE_EVENT(buzzer_stop,
+    TP_PROTO(bool stopped),
+    TP_ARGS(stopped),
+    TP_STRUCT__entry(
+        __field(bool, stopped)
+    ),
+    TP_fast_assign(
+        __entry->stopped = stopped;
+    ),
+    TP_printk("%s", __entry->stopped ? "stopped" : "done")
+);
+
+#endif
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#define TRACE_INCLUDE_FILE buzzer_trace
+#include <trace/define_trace.h>
@@ -4,8 +4,26 @@
 #include <linux/fs.h>
 #include <linux/uaccess.h>
 #include <linux/gpio.h>
+#include <linux/gpio/consumer.h>
 #include <linux/delay.h>
 #include <linux/mutex.h>
+#include <linux/ktime.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/nvmem-provider.h>
+#include <linux/spi/spi.h>
+#include <linux/completion.h>
+#include <linux/slab.h>
+#include <linux/mm.h>
+#include <linux/workqueue.h>
+
+#include "safe_status.h"
+#include "safe_events.h"
+#include "safe_hist.h"
+#include "safe_logic.h"
+
+#define CREATE_TRACE_POINTS
+#include "ds1302_trace.h"
 
 #define DS1302_ADDR_SECONDS  0x80
 #define DS1302_ADDR_MINUTES  0x82
@@ -14,6 +32,13 @@
 #define DS1302_ADDR_MONTH    0x88
 #define DS1302_ADDR_DOW      0x8A
 #define DS1302_ADDR_YEAR     0x8C
+#define DS1302_ADDR_WP       0x8E
+#define DS1302_ADDR_RAM0     0xC0
+
+// 배터리 백업 RAM (31바이트)
+#define DS1302_CMD_RAM_BURST 0xFE
+#define DS1302_RAM_SIZE      31
+#define DS1302_RAM_BURST_MIN 8   // 이 이상이면 단일 접근 반복보다 버스트 한 번이 빠름
 
 // ioctl
 #define DS1302_IOC_MAGIC  'd'
@@ -38,47 +63,343 @@ module_param(gpio_ce,  int, 0444);
 module_param(gpio_clk, int, 0444);
 module_param(gpio_io,  int, 0444);
 
+// 전송 백엔드: "gpio" (비트뱅) 또는 "spi" (SPI 코어, 3-wire/LSB first/CS high)
+static char *backend = "gpio";
+module_param(backend, charp, 0444);
+MODULE_PARM_DESC(backend, "transfer backend: gpio or spi");
+
 static DEFINE_MUTEX(ds_lock);
 
-static inline unsigned char bcd2dec(unsigned char b)
+// ---- 비트뱅 엔진 ----
+// gpiod 디스크립터 + 배열 연산으로 CLK/IO를 함께 갱신하고,
+// IO 방향은 전송당 한 번만 바꾼다. 지연값은 로드 시 데이터시트 최소값에 맞춰 보정.
+// 항상 ds_lock(mutex) 아래 프로세스 문맥에서 돌므로 _cansleep 변형을 쓴다
+// (gpio-sim, I2C 확장칩처럼 잠드는 라인에서도 동작, 일반 SoC GPIO에서는 비용 차이 없음).
+
+#define DS1302_CMD_CLK_BURST 0xBE
+#define DS1302_CAL_LOOPS     64
+
+// Vcc(mV): 데이터시트 타이밍 최소값 선택용 (2.0V~5.0V 사이 보간)
+static int vcc_mv = 3300;
+module_param(vcc_mv, int, 0444);
+MODULE_PARM_DESC(vcc_mv, "DS1302 supply voltage in mV (selects datasheet timing minimums)");
+
+struct ds1302_bb {
+    struct gpio_desc *ce;
+    struct gpio_desc *clk;
+    struct gpio_desc *io;
+    struct gpio_desc *clk_io[2]; // 배열 연산용 (bit0 = CLK, bit1 = IO)
+    bool io_out;                 // 현재 IO 방향 캐시
+    unsigned int op_ns;          // gpiod 호출 1회 비용 (측정값)
+    unsigned int t_cc;           // CE high -> 첫 CLK rising
+    unsigned int t_cl;           // CLK low 유지 (tCDD 포함)
+    unsigned int t_ch;           // CLK high 유지
+    unsigned int t_cch;          // 마지막 CLK -> CE low
+    unsigned int t_cwh;          // CE 비활성 유지
+};
+
+static struct ds1302_bb bb;
+
+// 데이터시트 최소값: Vcc 2.0V 값과 5.0V 값 사이를 선형 보간
+static unsigned int ds1302_tmin(unsigned int ns_2v, unsigned int ns_5v)
 {
-    return ((b >> 4) * 10) + (b & 0x0F);
+    int mv = clamp(vcc_mv, 2000, 5000);
+    return ns_2v - (ns_2v - ns_5v) * (mv - 2000) / 3000;
 }
-static inline unsigned char dec2bcd(unsigned char d)
+
+// GPIO 호출 자체가 걸리는 시간만큼은 추가로 기다릴 필요가 없음
+static unsigned int ds1302_pad(unsigned int min_ns)
 {
-    return ((d / 10) << 4) | (d % 10);
+    return min_ns > bb.op_ns ? min_ns - bb.op_ns : 0;
 }
 
-static inline void ce_high(void) { gpio_set_value(gpio_ce, 1); }
-static inline void ce_low(void)  { gpio_set_value(gpio_ce, 0); }
-static inline void clk_high(void){ gpio_set_value(gpio_clk, 1); }
-static inline void clk_low(void) { gpio_set_value(gpio_clk, 0); }
+static void ds1302_bb_calibrate(void)
+{
+    u64 t0;
+    int i;
+
+    // CE low 상태라 CLK를 흔들어도 칩은 무시함 (마지막 값은 low)
+    t0 = ktime_get_ns();
+    for (i = 0; i < DS1302_CAL_LOOPS; i++)
+        gpiod_set_value_cansleep(bb.clk, !(i & 1));
+    bb.op_ns = div_u64(ktime_get_ns() - t0, DS1302_CAL_LOOPS);
+
+    bb.t_cc  = ds1302_pad(ds1302_tmin(4000, 1000));
+    bb.t_cl  = ds1302_pad(max(ds1302_tmin(1000, 250), ds1302_tmin(800, 200)));
+    bb.t_ch  = ds1302_pad(ds1302_tmin(1000, 250));
+    bb.t_cch = ds1302_pad(ds1302_tmin(240, 60));
+    bb.t_cwh = ds1302_pad(ds1302_tmin(4000, 1000));
+}
 
-static inline void clk_pulse(void)
+static void ds1302_bb_io_dir(bool out)
 {
-    clk_high();
-    ndelay(200);
-    clk_low();
-    ndelay(200);
+    if (bb.io_out == out)
+        return;
+    if (out)
+        gpiod_direction_output(bb.io, 0);
+    else
+        gpiod_direction_input(bb.io);
+    bb.io_out = out;
 }
 
-static void io_dir_out(int val)
+static void ds1302_bb_tx(const u8 *tx, size_t len)
 {
-    gpio_direction_output(gpio_io, val);
+    unsigned long bits;
+    size_t n;
+    int i;
+
+    // LSB first, rising edge에서 칩이 샘플링
+    for (n = 0; n < len; n++) {
+        for (i = 0; i < 8; i++) {
+            // CLK low 와 데이터 비트를 한 번에 출력
+            bits = (tx[n] & (1U << i)) ? BIT(1) : 0;
+            gpiod_set_array_value_cansleep(2, bb.clk_io, NULL, &bits);
+            ndelay(bb.t_cl);
+            gpiod_set_value_cansleep(bb.clk, 1);
+            ndelay(bb.t_ch);
+        }
+    }
 }
-static void io_dir_in(void)
+
+static void ds1302_bb_rx(u8 *rx, size_t len)
 {
-    gpio_direction_input(gpio_io);
+    size_t n;
+    int i;
+    u8 v;
+
+    // falling edge마다 칩이 다음 비트를 내보냄 (버스트 시 다음 바이트로 이어짐)
+    for (n = 0; n < len; n++) {
+        v = 0;
+        for (i = 0; i < 8; i++) {
+            gpiod_set_value_cansleep(bb.clk, 0);
+            ndelay(bb.t_cl);
+            if (gpiod_get_value_cansleep(bb.io))
+                v |= (1U << i);
+            gpiod_set_value_cansleep(bb.clk, 1);
+            ndelay(bb.t_ch);
+        }
+        rx[n] = v;
+    }
+}
+
+// 명령 1바이트 + 데이터 len 바이트 (cmd bit0 = 1 이면 읽기). ds_lock 보유 상태에서 호출
+static void ds1302_bb_xfer(u8 cmd, const u8 *tx, u8 *rx, size_t len)
+{
+    ds1302_bb_io_dir(true);
+    gpiod_set_value_cansleep(bb.ce, 1);
+    ndelay(bb.t_cc);
+
+    ds1302_bb_tx(&cmd, 1);
+    if (cmd & 1) {
+        ds1302_bb_io_dir(false);
+        ds1302_bb_rx(rx, len);
+    } else {
+        ds1302_bb_tx(tx, len);
+    }
+
+    gpiod_set_value_cansleep(bb.clk, 0);
+    ndelay(bb.t_cch);
+    gpiod_set_value_cansleep(bb.ce, 0);
+    ndelay(bb.t_cwh);
+}
+
+// ---- SPI 백엔드 ----
+// 메시지를 spi_async로 한꺼번에 큐잉하고 마지막 완료만 기다린다.
+// 버퍼는 DMA 가능해야 하므로 호출자 스택 대신 kmalloc 영역으로 복사.
+struct ds1302_xfer {
+    u8 cmd;          // bit0 = 1 이면 읽기
+    u8 len;          // 최대 DS1302_RAM_SIZE
+    const u8 *tx;
+    u8 *rx;
+};
+
+struct ds1302_spi_msg {
+    struct spi_message m;
+    struct spi_transfer t[2];
+    u8 cmd;
+    u8 buf[DS1302_RAM_SIZE];
+};
+
+struct ds1302_spi_batch {
+    atomic_t pending;
+    struct completion done;
+};
+
+static struct spi_device *ds_spi;
+static bool use_spi;
+
+static void ds1302_spi_complete(void *ctx)
+{
+    struct ds1302_spi_batch *b = ctx;
+
+    if (atomic_dec_and_test(&b->pending))
+        complete(&b->done);
+}
+
+static int ds1302_spi_xfer(const struct ds1302_xfer *x, int n)
+{
+    struct ds1302_spi_batch batch;
+    struct ds1302_spi_msg *msgs;
+    int i, sent, ret = 0;
+
+    msgs = kcalloc(n, sizeof(*msgs), GFP_KERNEL);
+    if (!msgs)
+        return -ENOMEM;
+
+    init_completion(&batch.done);
+    atomic_set(&batch.pending, n + 1); // +1: 제출하는 쪽 참조
+
+    for (sent = 0; sent < n; sent++) {
+        struct ds1302_spi_msg *p = &msgs[sent];
+
+        p->cmd = x[sent].cmd;
+        p->t[0].tx_buf = &p->cmd;
+        p->t[0].len = 1;
+        if (p->cmd & 1) {
+            p->t[1].rx_buf = p->buf;
+        } else {
+            memcpy(p->buf, x[sent].tx, x[sent].len);
+            p->t[1].tx_buf = p->buf;
+        }
+        p->t[1].len = x[sent].len;
+        spi_message_init_with_transfers(&p->m, p->t, 2);
+        p->m.complete = ds1302_spi_complete;
+        p->m.context = &batch;
+
+        ret = spi_async(ds_spi, &p->m);
+        if (ret)
+            break;
+    }
+
+    // 제출하지 못한 메시지 몫과 자기 참조를 함께 내려놓음
+    if (atomic_sub_and_test(n - sent + 1, &batch.pending))
+        complete(&batch.done);
+    wait_for_completion(&batch.done);
+
+    for (i = 0; i < sent; i++) {
+        if (!ret && msgs[i].m.status)
+            ret = msgs[i].m.status;
+        if (msgs[i].cmd & 1)
+            memcpy(x[i].rx, msgs[i].buf, x[i].len);
+    }
+    kfree(msgs);
+    return ret;
+}
+
+// debugfs 통계 (/sys/kernel/debug/ds1302). ds_lock 아래에서만 갱신, stats에 1을 써야 켜짐
+static DEFINE_STATIC_KEY_FALSE(ds_stats);
+static u32 n_reads, n_writes, n_errors;
+static struct safe_hist xfer_hist;   // 비트뱅: 명령 1개, SPI: 묶음 1개
+
+static void ds1302_xfer_account(const struct ds1302_xfer *x, int n, int ret, u64 ns)
+{
+    int i;
+
+    trace_ds1302_xfer(x[0].cmd, x[0].len, n, ret, ns);
+    if (!safe_stats_on(&ds_stats))
+        return;
+    safe_hist_add(&xfer_hist, ns);
+    for (i = 0; i < n; i++) {
+        if (x[i].cmd & 1) n_reads++;
+        else n_writes++;
+    }
+    if (ret) n_errors++;
+}
+
+// 백엔드 공통 진입점. ds_lock 보유 상태에서 호출
+// 통계도 트레이스도 꺼져 있으면 시각을 재지 않음
+static int ds1302_xfer_batch(const struct ds1302_xfer *x, int n)
+{
+    bool timed = safe_stats_on(&ds_stats) || trace_ds1302_xfer_enabled();
+    ktime_t t0 = timed ? ktime_get() : 0;
+    int i, ret;
+
+    if (use_spi) {
+        ret = ds1302_spi_xfer(x, n);
+        if (timed)
+            ds1302_xfer_account(x, n, ret, ktime_to_ns(ktime_sub(ktime_get(), t0)));
+        return ret;
+    }
+
+    for (i = 0; i < n; i++) {
+        ds1302_bb_xfer(x[i].cmd, x[i].tx, x[i].rx, x[i].len);
+        if (timed) {
+            ds1302_xfer_account(&x[i], 1, 0, ktime_to_ns(ktime_sub(ktime_get(), t0)));
+            t0 = ktime_get();
+        }
+    }
+    return 0;
+}
+
+static int ds1302_xfer(u8 cmd, const u8 *tx, u8 *rx, size_t len)
+{
+    struct ds1302_xfer x = { .cmd = cmd, .len = len, .tx = tx, .rx = rx };
+
+    return ds1302_xfer_batch(&x, 1);
+}
+
+static int ds1302_get_time(struct ds1302_time *t)
+{
+    u8 raw[8];
+    int ret;
+
+    // 클럭 버스트: 초~연도(+WP)를 한 번의 전송으로 읽음
+    ret = ds1302_xfer(DS1302_CMD_CLK_BURST | 1, NULL, raw, sizeof(raw));
+    if (ret)
+        return ret;
+
+    t->sec   = safe_bcd2dec(raw[0]);
+    t->min   = safe_bcd2dec(raw[1]);
+    t->hour  = safe_bcd2dec(raw[2]);
+    t->date  = safe_bcd2dec(raw[3]);
+    t->month = safe_bcd2dec(raw[4]);
+    t->dow   = safe_bcd2dec(raw[5]);
+    t->year  = safe_bcd2dec(raw[6]);
+    return 0;
+}
+
+static const unsigned char ds1302_time_regs[] = {
+    DS1302_ADDR_SECONDS, DS1302_ADDR_MINUTES, DS1302_ADDR_HOURS, DS1302_ADDR_DATE,
+    DS1302_ADDR_MONTH, DS1302_ADDR_DOW, DS1302_ADDR_YEAR,
+};
+
+static int ds1302_set_time(const struct ds1302_time *t)
+{
+    const u8 val[] = { t->sec, t->min, t->hour, t->date, t->month, t->dow, t->year };
+    struct ds1302_xfer x[ARRAY_SIZE(ds1302_time_regs)];
+    u8 raw[ARRAY_SIZE(ds1302_time_regs)];
+    int i;
+
+    // 7개 레지스터 쓰기를 한 번에 제출 (SPI 백엔드에서는 모두 비동기 큐잉)
+    for (i = 0; i < ARRAY_SIZE(ds1302_time_regs); i++) {
+        raw[i] = safe_dec2bcd(val[i]);
+        x[i] = (struct ds1302_xfer){ .cmd = ds1302_time_regs[i], .len = 1, .tx = &raw[i] };
+    }
+    return ds1302_xfer_batch(x, ARRAY_SIZE(x));
+}
+
+// ---- 기존 구현 (벤치마크 비교용) ----
+static inline void ce_high(void) { gpio_set_value_cansleep(gpio_ce, 1); }
+static inline void ce_low(void)  { gpio_set_value_cansleep(gpio_ce, 0); }
+static inline void clk_high(void){ gpio_set_value_cansleep(gpio_clk, 1); }
+static inline void clk_low(void) { gpio_set_value_cansleep(gpio_clk, 0); }
+
+static inline void clk_pulse(void)
+{
+    clk_high();
+    ndelay(200);
+    clk_low();
+    ndelay(200);
 }
 
 static void ds1302_tx_byte(unsigned char tx)
 {
     int i;
-    io_dir_out(0);
+    gpio_direction_output(gpio_io, 0);
 
     // LSB first
     for (i = 0; i < 8; i++) {
-        gpio_set_value(gpio_io, !!(tx & (1U << i)));
+        gpio_set_value_cansleep(gpio_io, !!(tx & (1U << i)));
         clk_pulse();
     }
 }
@@ -88,10 +409,10 @@ static unsigned char ds1302_rx_byte(void)
     int i;
     unsigned char temp = 0;
 
-    io_dir_in();
+    gpio_direction_input(gpio_io);
 
     for (i = 0; i < 8; i++) {
-        if (gpio_get_value(gpio_io))
+        if (gpio_get_value_cansleep(gpio_io))
             temp |= (1U << i);
         if (i != 7)
             clk_pulse();
@@ -99,72 +420,237 @@ static unsigned char ds1302_rx_byte(void)
     return temp;
 }
 
-static void ds1302_begin(void)
+static unsigned char ds1302_legacy_read_reg(unsigned char addr)
 {
+    unsigned char raw;
     ce_high();
     ndelay(200);
-}
-
-static void ds1302_end(void)
-{
+    ds1302_tx_byte(addr + 1);
+    raw = ds1302_rx_byte();
     ndelay(200);
     ce_low();
     ndelay(200);
+    return raw;
+}
+
+#define DS1302_BENCH_BYTES 64
+#define DS1302_BENCH_READS 16
+
+// /sys/kernel/debug/ds1302/bench : 읽을 때마다 기존 구현과 엔진을 비교 측정
+static int ds1302_bench_show(struct seq_file *m, void *v)
+{
+    u8 buf[8] = { 0xA5 };
+    struct ds1302_time t;
+    u64 t0, old_tx, old_rx, old_time, new_tx, new_rx, new_time;
+    int i, j;
+
+    mutex_lock(&ds_lock);
+
+    // 바이트 단위 송수신은 CE low 상태에서 측정 (칩은 무시)
+    t0 = ktime_get_ns();
+    for (i = 0; i < DS1302_BENCH_BYTES; i++)
+        ds1302_tx_byte(buf[0]);
+    old_tx = ktime_get_ns() - t0;
+
+    t0 = ktime_get_ns();
+    for (i = 0; i < DS1302_BENCH_BYTES; i++)
+        buf[1] = ds1302_rx_byte();
+    old_rx = ktime_get_ns() - t0;
+
+    t0 = ktime_get_ns();
+    for (i = 0; i < DS1302_BENCH_READS; i++)
+        for (j = 0; j < ARRAY_SIZE(ds1302_time_regs); j++)
+            buf[1] = safe_bcd2dec(ds1302_legacy_read_reg(ds1302_time_regs[j]));
+    old_time = ktime_get_ns() - t0;
+
+    // 기존 구현이 IO 방향을 바꿔 놓았으므로 캐시를 다시 맞춤
+    bb.io_out = false;
+    ds1302_bb_io_dir(true);
+
+    t0 = ktime_get_ns();
+    for (i = 0; i < DS1302_BENCH_BYTES; i++)
+        ds1302_bb_tx(buf, 1);
+    new_tx = ktime_get_ns() - t0;
+    gpiod_set_value_cansleep(bb.clk, 0);
+
+    ds1302_bb_io_dir(false);
+    t0 = ktime_get_ns();
+    for (i = 0; i < DS1302_BENCH_BYTES; i++)
+        ds1302_bb_rx(&buf[1], 1);
+    new_rx = ktime_get_ns() - t0;
+    gpiod_set_value_cansleep(bb.clk, 0);
+
+    t0 = ktime_get_ns();
+    for (i = 0; i < DS1302_BENCH_READS; i++)
+        ds1302_get_time(&t);
+    new_time = ktime_get_ns() - t0;
+
+    mutex_unlock(&ds_lock);
+
+    seq_printf(m, "vcc_mv        %d\n", vcc_mv);
+    seq_printf(m, "gpio_op_ns    %u\n", bb.op_ns);
+    seq_printf(m, "delay_ns      cc=%u cl=%u ch=%u cch=%u cwh=%u\n",
+               bb.t_cc, bb.t_cl, bb.t_ch, bb.t_cch, bb.t_cwh);
+    seq_printf(m, "%-13s %10s %10s\n", "", "legacy", "bitbang");
+    seq_printf(m, "%-13s %10llu %10llu\n", "tx_byte_ns",
+               div_u64(old_tx, DS1302_BENCH_BYTES), div_u64(new_tx, DS1302_BENCH_BYTES));
+    seq_printf(m, "%-13s %10llu %10llu\n", "rx_byte_ns",
+               div_u64(old_rx, DS1302_BENCH_BYTES), div_u64(new_rx, DS1302_BENCH_BYTES));
+    seq_printf(m, "%-13s %10llu %10llu\n", "time_read_ns",
+               div_u64(old_time, DS1302_BENCH_READS), div_u64(new_time, DS1302_BENCH_READS));
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(ds1302_bench);
+
+static struct dentry *ds_debugfs;
+
+// ---- mmap 상태 페이지 / 초 틱 알림 ----
+// 매핑돼 있거나 틱 구독자가 있는 동안만 status_ms마다 시각을 읽어 seqlock으로 게시하고,
+// 초가 바뀌면 구독자에게 알린다. 앱은 ioctl 없이 페이지만 읽으면 된다. 쓰는 쪽은 이 work 하나뿐.
+static int status_ms = 100;
+module_param(status_ms, int, 0444);
+MODULE_PARM_DESC(status_ms, "RTC status page refresh period in ms while mapped");
+
+// 페이지는 모듈 로드부터 언로드까지 유지한다. SPI remove 뒤에도 남아 있는 매핑이
+// 해제된 페이지를 가리키지 않도록 (valid = 0으로 바꿔 두기만 함).
+// ds_ready: 백엔드가 붙어 있어 칩을 읽을 수 있는 동안만 true (ds_lock 아래에서 변경)
+static struct safe_rtc_status *rtc_status;
+static atomic_t rtc_maps = ATOMIC_INIT(0);
+static bool ds_ready;
+
+static BLOCKING_NOTIFIER_HEAD(rtc_tick_notifier);
+static atomic_t rtc_tick_users = ATOMIC_INIT(0);
+static int rtc_last_sec = -1;
+
+static void rtc_status_refresh(struct work_struct *w);
+static DECLARE_DELAYED_WORK(rtc_status_work, rtc_status_refresh);
+
+static bool rtc_status_active(void)
+{
+    return atomic_read(&rtc_maps) || atomic_read(&rtc_tick_users);
 }
 
-static void ds1302_write_reg(unsigned char addr, unsigned char data_dec)
+int ds1302_register_tick_notifier(struct notifier_block *nb)
 {
-    ds1302_begin();
-    ds1302_tx_byte(addr);                // write addr
-    ds1302_tx_byte(dec2bcd(data_dec));   // data
-    ds1302_end();
+    int ret;
+
+    // SPI 백엔드가 아직 probe되지 않았으면 읽을 장치가 없음
+    if (!READ_ONCE(ds_ready))
+        return -ENODEV;
+    ret = blocking_notifier_chain_register(&rtc_tick_notifier, nb);
+    if (!ret && atomic_inc_return(&rtc_tick_users) == 1)
+        mod_delayed_work(system_wq, &rtc_status_work, 0);
+    return ret;
 }
+EXPORT_SYMBOL_GPL(ds1302_register_tick_notifier);
 
-static unsigned char ds1302_read_reg(unsigned char addr)
+int ds1302_unregister_tick_notifier(struct notifier_block *nb)
 {
-    unsigned char raw;
-    ds1302_begin();
-    ds1302_tx_byte(addr + 1);  // read = write+1
-    raw = ds1302_rx_byte();
-    ds1302_end();
-    return bcd2dec(raw);
+    int ret = blocking_notifier_chain_unregister(&rtc_tick_notifier, nb);
+
+    if (!ret)
+        atomic_dec(&rtc_tick_users);
+    return ret;
+}
+EXPORT_SYMBOL_GPL(ds1302_unregister_tick_notifier);
+
+static void rtc_status_refresh(struct work_struct *w)
+{
+    struct ds1302_time t;
+    int ret;
+
+    mutex_lock(&ds_lock);
+    if (!ds_ready) {
+        // remove 중: 다시 예약하지 않음 (다음 probe에서 재시작)
+        mutex_unlock(&ds_lock);
+        return;
+    }
+    ret = ds1302_get_time(&t);
+    mutex_unlock(&ds_lock);
+
+    if (!ret) {
+        WRITE_ONCE(rtc_status->seq, rtc_status->seq + 1);
+        smp_wmb();
+        rtc_status->year  = t.year;
+        rtc_status->month = t.month;
+        rtc_status->date  = t.date;
+        rtc_status->dow   = t.dow;
+        rtc_status->hour  = t.hour;
+        rtc_status->min   = t.min;
+        rtc_status->sec   = t.sec;
+        rtc_status->valid = 1;
+        rtc_status->ts_ns = ktime_get_ns();
+        smp_wmb();
+        WRITE_ONCE(rtc_status->seq, rtc_status->seq + 1);
+
+        if (t.sec != rtc_last_sec) {
+            rtc_last_sec = t.sec;
+            blocking_notifier_call_chain(&rtc_tick_notifier, 0,
+                                         (void *)(long)(t.hour * 3600 + t.min * 60 + t.sec));
+        }
+    }
+
+    if (rtc_status_active())
+        schedule_delayed_work(&rtc_status_work, msecs_to_jiffies(max(status_ms, 10)));
 }
 
-static void ds1302_get_time(struct ds1302_time *t)
+// fork/분할로 매핑이 늘어나거나 줄어들 때
+static void rtc_vm_open(struct vm_area_struct *vma)
 {
-    t->sec   = ds1302_read_reg(DS1302_ADDR_SECONDS);
-    t->min   = ds1302_read_reg(DS1302_ADDR_MINUTES);
-    t->hour  = ds1302_read_reg(DS1302_ADDR_HOURS);
-    t->date  = ds1302_read_reg(DS1302_ADDR_DATE);
-    t->month = ds1302_read_reg(DS1302_ADDR_MONTH);
-    t->dow   = ds1302_read_reg(DS1302_ADDR_DOW);
-    t->year  = ds1302_read_reg(DS1302_ADDR_YEAR);
+    atomic_inc(&rtc_maps);
 }
 
-static void ds1302_set_time(const struct ds1302_time *t)
+static void rtc_vm_close(struct vm_area_struct *vma)
 {
-    ds1302_write_reg(DS1302_ADDR_SECONDS, t->sec);
-    ds1302_write_reg(DS1302_ADDR_MINUTES, t->min);
-    ds1302_write_reg(DS1302_ADDR_HOURS,   t->hour);
-    ds1302_write_reg(DS1302_ADDR_DATE,    t->date);
-    ds1302_write_reg(DS1302_ADDR_MONTH,   t->month);
-    ds1302_write_reg(DS1302_ADDR_DOW,     t->dow);
-    ds1302_write_reg(DS1302_ADDR_YEAR,    t->year);
+    atomic_dec(&rtc_maps);
+}
+
+static const struct vm_operations_struct rtc_vm_ops = {
+    .open  = rtc_vm_open,
+    .close = rtc_vm_close,
+};
+
+static int ds1302_mmap(struct file *f, struct vm_area_struct *vma)
+{
+    int ret;
+
+    if (vma->vm_pgoff || vma->vm_end - vma->vm_start > PAGE_SIZE)
+        return -EINVAL;
+    if (vma->vm_flags & VM_WRITE)
+        return -EPERM;
+    vma->vm_flags &= ~VM_MAYWRITE;
+
+    ret = remap_pfn_range(vma, vma->vm_start, virt_to_phys(rtc_status) >> PAGE_SHIFT,
+                          PAGE_SIZE, vma->vm_page_prot);
+    if (ret)
+        return ret;
+
+    vma->vm_ops = &rtc_vm_ops;
+    atomic_inc(&rtc_maps);
+    mod_delayed_work(system_wq, &rtc_status_work, 0);
+    return 0;
 }
 
 static long ds1302_ioctl(struct file *f, unsigned int cmd, unsigned long arg)
 {
     struct ds1302_time t;
+    int ret;
 
     if (_IOC_TYPE(cmd) != DS1302_IOC_MAGIC)
         return -ENOTTY;
 
     mutex_lock(&ds_lock);
+    if (!ds_ready) {
+        mutex_unlock(&ds_lock);
+        return -ENODEV;
+    }
 
     switch (cmd) {
     case DS1302_IOC_GET:
-        ds1302_get_time(&t);
+        ret = ds1302_get_time(&t);
         mutex_unlock(&ds_lock);
+        if (ret)
+            return ret;
         if (copy_to_user((void __user *)arg, &t, sizeof(t)))
             return -EFAULT;
         return 0;
@@ -174,9 +660,12 @@ static long ds1302_ioctl(struct file *f, unsigned int cmd, unsigned long arg)
             mutex_unlock(&ds_lock);
             return -EFAULT;
         }
-        ds1302_set_time(&t);
+        ret = ds1302_set_time(&t);
         mutex_unlock(&ds_lock);
-        return 0;
+        // 매핑 중이면 바뀐 시각을 바로 게시
+        if (!ret && rtc_status_active())
+            mod_delayed_work(system_wq, &rtc_status_work, 0);
+        return ret;
 
     default:
         mutex_unlock(&ds_lock);
@@ -188,6 +677,7 @@ static const struct file_operations ds1302_fops = {
     .owner          = THIS_MODULE,
     .unlocked_ioctl = ds1302_ioctl,
     .compat_ioctl   = ds1302_ioctl,
+    .mmap           = ds1302_mmap,
 };
 
 static struct miscdevice ds1302_misc = {
@@ -197,40 +687,257 @@ static struct miscdevice ds1302_misc = {
     .mode  = 0666,
 };
 
+// ---- nvmem: 배터리 백업 RAM ----
+// RAM 버스트는 항상 RAM0부터 31바이트 전체를 주고받으므로
+// 짧은 구간은 바이트 단위로, 긴 구간은 블록 버스트로 처리한다.
+static struct nvmem_device *ds_nvmem;
+
+static int ds1302_ram_read(void *priv, unsigned int off, void *val, size_t bytes)
+{
+    u8 ram[DS1302_RAM_SIZE];
+    u8 *dst = val;
+    size_t i;
+    int ret = 0;
+
+    mutex_lock(&ds_lock);
+    if (bytes >= DS1302_RAM_BURST_MIN) {
+        ret = ds1302_xfer(DS1302_CMD_RAM_BURST | 1, NULL, ram, sizeof(ram));
+        if (!ret)
+            memcpy(dst, ram + off, bytes);
+    } else {
+        for (i = 0; i < bytes && !ret; i++)
+            ret = ds1302_xfer((DS1302_ADDR_RAM0 + 2 * (off + i)) | 1, NULL, &dst[i], 1);
+    }
+    mutex_unlock(&ds_lock);
+    return ret;
+}
+
+static int ds1302_ram_write(void *priv, unsigned int off, void *val, size_t bytes)
+{
+    u8 ram[DS1302_RAM_SIZE];
+    const u8 *src = val;
+    size_t i;
+    int ret = 0;
+
+    mutex_lock(&ds_lock);
+    if (bytes >= DS1302_RAM_BURST_MIN) {
+        // 부분 블록이면 나머지 바이트를 보존하기 위해 먼저 읽어 둠
+        if (bytes < DS1302_RAM_SIZE)
+            ret = ds1302_xfer(DS1302_CMD_RAM_BURST | 1, NULL, ram, sizeof(ram));
+        if (!ret) {
+            memcpy(ram + off, src, bytes);
+            ret = ds1302_xfer(DS1302_CMD_RAM_BURST, ram, NULL, sizeof(ram));
+        }
+    } else {
+        for (i = 0; i < bytes && !ret; i++)
+            ret = ds1302_xfer(DS1302_ADDR_RAM0 + 2 * (off + i), &src[i], NULL, 1);
+    }
+    mutex_unlock(&ds_lock);
+    return ret;
+}
+
+static void ds1302_ram_register(void)
+{
+    struct nvmem_config cfg = {
+        .dev       = ds1302_misc.this_device,
+        .name      = "ds1302_ram",
+        .id        = NVMEM_DEVID_NONE,
+        .owner     = THIS_MODULE,
+        .type      = NVMEM_TYPE_BATTERY_BACKED,
+        .word_size = 1,
+        .stride    = 1,
+        .size      = DS1302_RAM_SIZE,
+        .reg_read  = ds1302_ram_read,
+        .reg_write = ds1302_ram_write,
+    };
+
+    ds_nvmem = nvmem_register(&cfg);
+    if (IS_ERR(ds_nvmem)) {
+        // RAM 없이도 시계 기능은 동작하므로 경고만 남김
+        pr_warn("ds1302: nvmem register failed (%ld)\n", PTR_ERR(ds_nvmem));
+        ds_nvmem = NULL;
+    }
+}
+
+// 백엔드 준비가 끝난 뒤 공통 장치 등록 (/dev/ds1302, nvmem, debugfs)
+static int ds1302_dev_register(void)
+{
+    u8 wp = 0;
+    int ret;
+
+    // 쓰기 보호 해제 (전원 투입 시 WP 상태는 정해져 있지 않음)
+    mutex_lock(&ds_lock);
+    ret = ds1302_xfer(DS1302_ADDR_WP, &wp, NULL, 1);
+    mutex_unlock(&ds_lock);
+    if (ret)
+        return ret;
+
+    ret = misc_register(&ds1302_misc);
+    if (ret)
+        return ret;
+
+    ds1302_ram_register();
+
+    mutex_lock(&ds_lock);
+    ds_ready = true;
+    mutex_unlock(&ds_lock);
+    // 이전 remove 동안 남아 있던 매핑/구독자가 있으면 갱신 재개
+    if (rtc_status_active())
+        mod_delayed_work(system_wq, &rtc_status_work, 0);
+
+    // 벤치마크는 GPIO 비트뱅 전용
+    ds_debugfs = debugfs_create_dir("ds1302", NULL);
+    debugfs_create_u32("reads", 0444, ds_debugfs, &n_reads);
+    debugfs_create_u32("writes", 0444, ds_debugfs, &n_writes);
+    debugfs_create_u32("errors", 0444, ds_debugfs, &n_errors);
+    safe_hist_debugfs("xfer_hist", ds_debugfs, &xfer_hist);
+    safe_stats_debugfs(ds_debugfs, &ds_stats);
+    if (!use_spi)
+        debugfs_create_file("bench", 0444, ds_debugfs, NULL, &ds1302_bench_fops);
+    return 0;
+}
+
+static void ds1302_dev_unregister(void)
+{
+    // 이 뒤로는 work/ioctl이 칩에 접근하지 않음. 매핑은 남아 있을 수 있으므로
+    // 페이지는 해제하지 않고 무효 표시만 게시 (해제는 모듈 언로드 때)
+    mutex_lock(&ds_lock);
+    ds_ready = false;
+    mutex_unlock(&ds_lock);
+    cancel_delayed_work_sync(&rtc_status_work);
+
+    WRITE_ONCE(rtc_status->seq, rtc_status->seq + 1);
+    smp_wmb();
+    rtc_status->valid = 0;
+    smp_wmb();
+    WRITE_ONCE(rtc_status->seq, rtc_status->seq + 1);
+    rtc_last_sec = -1;
+
+    debugfs_remove_recursive(ds_debugfs);
+    if (ds_nvmem)
+        nvmem_unregister(ds_nvmem);
+    misc_deregister(&ds1302_misc);
+}
+
+// ---- SPI 드라이버 바인딩 ----
+static int ds1302_spi_probe(struct spi_device *spi)
+{
+    int ret;
+
+    // CE = CS(active high), IO = 3-wire 양방향 데이터, LSB first
+    spi->mode = SPI_MODE_0 | SPI_3WIRE | SPI_LSB_FIRST | SPI_CS_HIGH;
+    spi->bits_per_word = 8;
+    if (!spi->max_speed_hz || spi->max_speed_hz > NSEC_PER_SEC / (2 * ds1302_tmin(1000, 250)))
+        spi->max_speed_hz = NSEC_PER_SEC / (2 * ds1302_tmin(1000, 250));
+    ret = spi_setup(spi);
+    if (ret)
+        return ret;
+
+    ds_spi = spi;
+    ret = ds1302_dev_register();
+    if (ret)
+        return ret;
+
+    dev_info(&spi->dev, "ds1302: loaded (spi %u Hz)\n", spi->max_speed_hz);
+    return 0;
+}
+
+static void ds1302_spi_remove(struct spi_device *spi)
+{
+    ds1302_dev_unregister();
+}
+
+static const struct of_device_id ds1302_of_match[] = {
+    { .compatible = "custom,ds1302-rtc" },
+    { }
+};
+MODULE_DEVICE_TABLE(of, ds1302_of_match);
+
+static const struct spi_device_id ds1302_spi_id[] = {
+    { "ds1302_char", 0 },
+    { }
+};
+MODULE_DEVICE_TABLE(spi, ds1302_spi_id);
+
+static struct spi_driver ds1302_spi_driver = {
+    .driver = {
+        .name = "ds1302_char",
+        .of_match_table = ds1302_of_match,
+    },
+    .probe    = ds1302_spi_probe,
+    .remove   = ds1302_spi_remove,
+    .id_table = ds1302_spi_id,
+};
+
 static int __init ds1302_init(void)
 {
     int ret;
 
+    if (strcmp(backend, "spi") && strcmp(backend, "gpio"))
+        return -EINVAL;
+
+    // 상태 페이지는 백엔드 probe/remove와 무관하게 모듈 수명 동안 유지
+    rtc_status = (void *)get_zeroed_page(GFP_KERNEL);
+    if (!rtc_status)
+        return -ENOMEM;
+
+    if (!strcmp(backend, "spi")) {
+        use_spi = true;
+        ret = spi_register_driver(&ds1302_spi_driver);
+        if (ret)
+            free_page((unsigned long)rtc_status);
+        return ret;
+    }
+
     // GPIO 요청
     ret = gpio_request(gpio_ce, "ds1302_ce");
-    if (ret) return ret;
+    if (ret) goto err_page;
     ret = gpio_request(gpio_clk, "ds1302_clk");
-    if (ret) { gpio_free(gpio_ce); return ret; }
+    if (ret) { gpio_free(gpio_ce); goto err_page; }
     ret = gpio_request(gpio_io, "ds1302_io");
-    if (ret) { gpio_free(gpio_ce); gpio_free(gpio_clk); return ret; }
+    if (ret) { gpio_free(gpio_ce); gpio_free(gpio_clk); goto err_page; }
 
     gpio_direction_output(gpio_ce, 0);
     gpio_direction_output(gpio_clk, 0);
-    io_dir_out(0);
+    gpio_direction_output(gpio_io, 0);
 
-    ret = misc_register(&ds1302_misc);
+    bb.ce  = gpio_to_desc(gpio_ce);
+    bb.clk = gpio_to_desc(gpio_clk);
+    bb.io  = gpio_to_desc(gpio_io);
+    bb.clk_io[0] = bb.clk;
+    bb.clk_io[1] = bb.io;
+    bb.io_out = true;
+    ds1302_bb_calibrate();
+
+    ret = ds1302_dev_register();
     if (ret) {
         gpio_free(gpio_ce);
         gpio_free(gpio_clk);
         gpio_free(gpio_io);
-        return ret;
+        goto err_page;
     }
 
-    pr_info("ds1302: loaded (ce=%d clk=%d io=%d)\n", gpio_ce, gpio_clk, gpio_io);
+    pr_info("ds1302: loaded (ce=%d clk=%d io=%d, gpio op %u ns)\n",
+            gpio_ce, gpio_clk, gpio_io, bb.op_ns);
     return 0;
+
+err_page:
+    free_page((unsigned long)rtc_status);
+    return ret;
 }
 
 static void __exit ds1302_exit(void)
 {
-    misc_deregister(&ds1302_misc);
-    gpio_free(gpio_ce);
-    gpio_free(gpio_clk);
-    gpio_free(gpio_io);
+    if (use_spi) {
+        spi_unregister_driver(&ds1302_spi_driver);
+    } else {
+        ds1302_dev_unregister();
+        gpio_free(gpio_ce);
+        gpio_free(gpio_clk);
+        gpio_free(gpio_io);
+    }
+    // 매핑이 남아 있으면 /dev/ds1302 파일 참조 때문에 여기까지 오지 않음
+    free_page((unsigned long)rtc_status);
     pr_info("ds1302: unloaded\n");
 }
 
@@ -239,4 +946,4 @@ module_exit(ds1302_exit);
 
 MODULE_LICENSE("GPL");
 MODULE_AUTHOR("you");
-MODULE_DESCRIPTION("DS1302 GPIO bitbang driver (/dev/ds1302)");
+MODULE_DESCRIPTION("DS1302 GPIO bitbang / SPI driver (/dev/ds1302)");
@@ -0,0 +1,97 @@
+#!/bin/sh
+# DS1302 SPI 백엔드 점검 (하드웨어 없이, ds1302_spi_stub 위에서)
+#
+#   make native
+#   sudo ./ds1302_spi_check.sh
+#
+# nvmem RAM의 단일 접근 / 전체 버스트 / 부분 버스트(읽고-고쳐-쓰기) 경로와
+# 클럭 버스트(mmap 상태 페이지)를 돌려 보고, 바인딩을 푼 뒤에도 남아 있는
+# 매핑이 안전한지(valid = 0) 확인한다. 실패하면 종료 코드 1.
+set -e
+
+STUB=/sys/kernel/debug/ds1302_stub
+NV=/sys/bus/nvmem/devices/ds1302_ram/nvmem
+TMP=$(mktemp -d)
+FAIL=0
+
+cleanup() {
+    rmmod ds1302 ds1302_spi_stub 2>/dev/null || true
+    rm -rf "$TMP"
+}
+trap cleanup EXIT
+
+fail() {
+    echo "FAIL: $*"
+    FAIL=1
+}
+
+# debugfs 카운터 증가량
+cnt() { cat $STUB/$1; }
+
+insmod ds1302_spi_stub.ko
+insmod ds1302.ko backend=spi
+[ -e $NV ] || { echo "no $NV"; exit 1; }
+
+# 1) 전체 버스트 쓰기 + 버스트 읽기
+B=$(cnt ram_bursts)
+head -c 31 /dev/urandom > $TMP/full
+dd if=$TMP/full of=$NV bs=31 count=1 2>/dev/null
+dd if=$NV of=$TMP/back bs=31 count=1 2>/dev/null
+cmp -s $TMP/full $TMP/back || fail "full burst read-back"
+cmp -s $TMP/full $STUB/ram || fail "full burst: stub RAM differs"
+[ $(($(cnt ram_bursts) - B)) -eq 2 ] || fail "full burst: expected 2 RAM bursts"
+
+# 2) 짧은 구간은 단일 접근 (버스트 없음)
+B=$(cnt ram_bursts); S=$(cnt singles)
+printf 'abc' | dd of=$NV bs=3 seek=1 oflag=seek_bytes conv=notrunc 2>/dev/null
+printf 'abc' | dd of=$TMP/full bs=3 seek=1 oflag=seek_bytes conv=notrunc 2>/dev/null
+cmp -s $TMP/full $STUB/ram || fail "single write"
+[ $(cnt ram_bursts) -eq $B ] || fail "single write used a burst"
+[ $(($(cnt singles) - S)) -eq 3 ] || fail "single write: expected 3 accesses"
+
+# 3) 부분 버스트: 먼저 읽어 두고 나머지 바이트를 보존
+B=$(cnt ram_bursts)
+printf '0123456789' | dd of=$NV bs=10 seek=12 oflag=seek_bytes conv=notrunc 2>/dev/null
+printf '0123456789' | dd of=$TMP/full bs=10 seek=12 oflag=seek_bytes conv=notrunc 2>/dev/null
+cmp -s $TMP/full $STUB/ram || fail "partial burst did not preserve other bytes"
+[ $(($(cnt ram_bursts) - B)) -eq 2 ] || fail "partial burst: expected read + write burst"
+
+# 4) 클럭 버스트 (상태 페이지) + 매핑 중 unbind
+if command -v python3 > /dev/null; then
+    DEV=$(basename "$(readlink -f /sys/bus/spi/drivers/ds1302_char/spi*)")
+    python3 - "$DEV" <<'EOF' || FAIL=1
+import mmap, os, struct, sys, time
+
+def snap(m):
+    while True:
+        s1 = struct.unpack_from('<I', m, 0)[0]
+        v = struct.unpack_from('<IIBBBBBBBB', m, 0)
+        if not s1 & 1 and struct.unpack_from('<I', m, 0)[0] == s1:
+            return v
+
+fd = os.open('/dev/ds1302', os.O_RDONLY)
+m = mmap.mmap(fd, mmap.PAGESIZE, mmap.MAP_SHARED, mmap.PROT_READ)
+os.close(fd)
+time.sleep(0.5)
+v = snap(m)
+if v[1] != 1:
+    sys.exit('FAIL: status page not valid after mmap')
+print('clock %02d:%02d:%02d' % (v[6], v[7], v[8]))
+
+# 매핑을 든 채로 드라이버 바인딩 해제 -> 페이지는 남고 valid = 0
+open('/sys/bus/spi/drivers/ds1302_char/unbind', 'w').write(sys.argv[1])
+if snap(m)[1] != 0:
+    sys.exit('FAIL: status page still valid after unbind')
+open('/sys/bus/spi/drivers/ds1302_char/bind', 'w').write(sys.argv[1])
+time.sleep(0.5)
+if snap(m)[1] != 1:
+    sys.exit('FAIL: status page not refreshed after rebind')
+m.close()
+EOF
+    [ "$(cnt clk_bursts)" -gt 0 ] || fail "no clock bursts"
+else
+    echo "python3 not found, skipping mmap/unbind check"
+fi
+
+[ $FAIL = 0 ] && echo "ds1302 spi: OK"
+exit $FAIL
@@ -0,0 +1,252 @@
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/platform_device.h>
+#include <linux/spi/spi.h>
+#include <linux/delay.h>
+#include <linux/bcd.h>
+#include <linux/time.h>
+#include <linux/timekeeping.h>
+#include <linux/debugfs.h>
+
+// 하드웨어 없이 ds1302 backend=spi 를 돌리기 위한 가짜 SPI 컨트롤러 + DS1302.
+// 3-wire / LSB first / CS high 모드를 받아 주고, 메시지 하나 = CE 구간 하나로 보고
+// 첫 바이트를 명령, 나머지를 데이터로 해석한다. 시계 레지스터, 클럭 버스트,
+// 31바이트 RAM (단일/버스트), 쓰기 보호(WP)를 흉내낸다. 시계는 실제 시각을 따라 흐름.
+//   insmod ds1302_spi_stub.ko && insmod ds1302.ko backend=spi
+//   /sys/kernel/debug/ds1302_stub/cmds       : 받은 명령 수 (메시지 수)
+//   /sys/kernel/debug/ds1302_stub/singles    : 단일 레지스터/RAM 접근 수
+//   /sys/kernel/debug/ds1302_stub/clk_bursts : 클럭 버스트 수
+//   /sys/kernel/debug/ds1302_stub/ram_bursts : RAM 버스트 수
+//   /sys/kernel/debug/ds1302_stub/wp_blocked : WP 때문에 무시한 쓰기 바이트 수
+//   /sys/kernel/debug/ds1302_stub/ram        : RAM 31바이트 (읽기 전용)
+
+#define STUB_RAM_SIZE   31
+#define STUB_BURST_ADDR 31   // 명령 bit5..1 = 11111 이면 버스트
+
+// 버스 속도 흉내 (0이면 지연 없음). 전송당 spi_transfer.speed_hz 기준
+static bool bus_delay = true;
+module_param(bus_delay, bool, 0444);
+MODULE_PARM_DESC(bus_delay, "sleep for the simulated wire time of every transfer");
+
+enum { REG_SEC, REG_MIN, REG_HOUR, REG_DATE, REG_MONTH, REG_DOW, REG_YEAR, REG_WP, STUB_CLK_REGS };
+
+static u8 stub_ram[STUB_RAM_SIZE];
+static time64_t clk_off;     // (칩 시각 - 실제 시각) 초
+static u8 clk_dow = 1;
+static u8 clk_wp = 0x80;     // 전원 투입 직후처럼 보호 상태로 시작
+
+static u32 n_cmds, n_singles, n_clk_bursts, n_ram_bursts, n_wp_blocked;
+
+static struct platform_device *stub_pdev;
+static struct spi_controller *stub_ctlr;
+static struct spi_device *stub_spi;
+static struct dentry *stub_debugfs;
+static struct debugfs_blob_wrapper ram_blob = { .data = stub_ram, .size = STUB_RAM_SIZE };
+
+static void stub_now(struct tm *tm)
+{
+    time64_to_tm(ktime_get_real_seconds() + clk_off, 0, tm);
+}
+
+static u8 stub_clk_read(int reg)
+{
+    struct tm tm;
+
+    stub_now(&tm);
+    switch (reg) {
+    case REG_SEC:   return bin2bcd(tm.tm_sec);
+    case REG_MIN:   return bin2bcd(tm.tm_min);
+    case REG_HOUR:  return bin2bcd(tm.tm_hour);   // 24시간제
+    case REG_DATE:  return bin2bcd(tm.tm_mday);
+    case REG_MONTH: return bin2bcd(tm.tm_mon + 1);
+    case REG_DOW:   return clk_dow;
+    case REG_YEAR:  return bin2bcd((tm.tm_year + 1900) % 100);
+    case REG_WP:    return clk_wp;
+    }
+    return 0;
+}
+
+// 필드 하나를 바꾼 시각으로 오프셋을 다시 계산 (칩처럼 나머지 필드는 계속 흐름)
+static void stub_clk_write(int reg, u8 v)
+{
+    struct tm tm;
+    unsigned int sec, min, hour, mday, mon, year;
+
+    if (reg == REG_WP) {
+        clk_wp = v & 0x80;
+        return;
+    }
+    if (clk_wp) {
+        n_wp_blocked++;
+        return;
+    }
+
+    stub_now(&tm);
+    sec = tm.tm_sec; min = tm.tm_min; hour = tm.tm_hour;
+    mday = tm.tm_mday; mon = tm.tm_mon + 1; year = tm.tm_year + 1900;
+
+    switch (reg) {
+    case REG_SEC:   sec = bcd2bin(v & 0x7F) % 60; break;   // bit7 = CH (무시)
+    case REG_MIN:   min = bcd2bin(v) % 60; break;
+    case REG_HOUR:  hour = bcd2bin(v & 0x3F) % 24; break;
+    case REG_DATE:  mday = clamp_t(unsigned int, bcd2bin(v), 1, 31); break;
+    case REG_MONTH: mon = clamp_t(unsigned int, bcd2bin(v), 1, 12); break;
+    case REG_DOW:   clk_dow = v; return;
+    case REG_YEAR:  year = 2000 + bcd2bin(v) % 100; break;
+    default:        return;
+    }
+    clk_off = mktime64(year, mon, mday, hour, min, sec) - ktime_get_real_seconds();
+}
+
+// 명령 뒤 pos번째 데이터 바이트 처리. 읽기면 돌려줄 값을 반환
+static u8 stub_data(u8 cmd, unsigned int pos, u8 in)
+{
+    bool rd = cmd & 1, ram = cmd & 0x40;
+    unsigned int addr = (cmd >> 1) & 0x1F;
+
+    if (addr == STUB_BURST_ADDR) {
+        addr = pos;                     // 버스트: 0번부터 차례로
+        if (addr >= (ram ? STUB_RAM_SIZE : STUB_CLK_REGS))
+            return 0;
+    } else if (pos) {
+        return 0;                       // 단일 접근은 데이터 1바이트만 의미 있음
+    }
+
+    if (ram) {
+        if (addr >= STUB_RAM_SIZE)
+            return 0;
+        if (rd)
+            return stub_ram[addr];
+        if (clk_wp)
+            n_wp_blocked++;
+        else
+            stub_ram[addr] = in;
+        return 0;
+    }
+
+    if (addr >= STUB_CLK_REGS)
+        return 0;                       // 트리클 차저 등은 흉내내지 않음
+    if (rd)
+        return stub_clk_read(addr);
+    stub_clk_write(addr, in);
+    return 0;
+}
+
+// 메시지 하나 = CE high 구간 하나 (ds1302는 명령 전송 + 데이터 전송 2개로 보냄)
+static int stub_transfer_one_message(struct spi_controller *ctlr, struct spi_message *msg)
+{
+    struct spi_transfer *t;
+    bool have_cmd = false;
+    unsigned int pos = 0;
+    u8 cmd = 0;
+    int i;
+
+    list_for_each_entry(t, &msg->transfers, transfer_list) {
+        const u8 *tx = t->tx_buf;
+        u8 *rx = t->rx_buf;
+
+        for (i = 0; i < t->len; i++) {
+            u8 in = tx ? tx[i] : 0;
+
+            if (!have_cmd) {
+                cmd = in;
+                have_cmd = true;
+                n_cmds++;
+                if (((cmd >> 1) & 0x1F) != STUB_BURST_ADDR)
+                    n_singles++;
+                else if (cmd & 0x40)
+                    n_ram_bursts++;
+                else
+                    n_clk_bursts++;
+                if (rx)
+                    rx[i] = 0;
+                continue;
+            }
+            // bit7 = 0 인 명령은 칩이 무시
+            in = (cmd & 0x80) ? stub_data(cmd, pos++, in) : 0;
+            if (rx)
+                rx[i] = in;
+        }
+
+        if (bus_delay && t->len && t->speed_hz)
+            fsleep(DIV_ROUND_UP_ULL((u64)t->len * 8 * USEC_PER_SEC, t->speed_hz));
+        msg->actual_length += t->len;
+    }
+
+    msg->status = 0;
+    spi_finalize_current_message(ctlr);
+    return 0;
+}
+
+static int __init ds1302_stub_init(void)
+{
+    struct spi_board_info info = {
+        .modalias     = "ds1302_char",
+        .max_speed_hz = 2000000,
+        .chip_select  = 0,
+        .mode         = SPI_MODE_0 | SPI_3WIRE | SPI_LSB_FIRST | SPI_CS_HIGH,
+    };
+    int ret;
+
+    stub_pdev = platform_device_register_simple("ds1302-spi-stub", -1, NULL, 0);
+    if (IS_ERR(stub_pdev))
+        return PTR_ERR(stub_pdev);
+
+    stub_ctlr = spi_alloc_master(&stub_pdev->dev, 0);
+    if (!stub_ctlr) {
+        ret = -ENOMEM;
+        goto err_pdev;
+    }
+    stub_ctlr->bus_num = -1;
+    stub_ctlr->num_chipselect = 1;
+    stub_ctlr->mode_bits = SPI_3WIRE | SPI_LSB_FIRST | SPI_CS_HIGH;
+    stub_ctlr->bits_per_word_mask = SPI_BPW_MASK(8);
+    stub_ctlr->max_speed_hz = info.max_speed_hz;
+    stub_ctlr->transfer_one_message = stub_transfer_one_message;
+
+    ret = spi_register_controller(stub_ctlr);
+    if (ret) {
+        spi_controller_put(stub_ctlr);
+        goto err_pdev;
+    }
+
+    // ds1302 모듈(backend=spi)이 올라와 있으면 바로, 아니면 로드될 때 붙음
+    stub_spi = spi_new_device(stub_ctlr, &info);
+    if (!stub_spi) {
+        ret = -ENODEV;
+        goto err_ctlr;
+    }
+
+    stub_debugfs = debugfs_create_dir("ds1302_stub", NULL);
+    debugfs_create_u32("cmds", 0444, stub_debugfs, &n_cmds);
+    debugfs_create_u32("singles", 0444, stub_debugfs, &n_singles);
+    debugfs_create_u32("clk_bursts", 0444, stub_debugfs, &n_clk_bursts);
+    debugfs_create_u32("ram_bursts", 0444, stub_debugfs, &n_ram_bursts);
+    debugfs_create_u32("wp_blocked", 0444, stub_debugfs, &n_wp_blocked);
+    debugfs_create_blob("ram", 0444, stub_debugfs, &ram_blob);
+
+    pr_info("ds1302_stub: spi%d.0 ready, load ds1302 with backend=spi\n", stub_ctlr->bus_num);
+    return 0;
+
+err_ctlr:
+    spi_unregister_controller(stub_ctlr);
+err_pdev:
+    platform_device_unregister(stub_pdev);
+    return ret;
+}
+
+static void __exit ds1302_stub_exit(void)
+{
+    debugfs_remove_recursive(stub_debugfs);
+    // 자식 spi_device (ds1302 바인딩 포함)도 함께 제거됨
+    spi_unregister_controller(stub_ctlr);
+    platform_device_unregister(stub_pdev);
+}
+
+module_init(ds1302_stub_init);
+module_exit(ds1302_stub_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_AUTHOR("kkk");
+MODULE_DESCRIPTION("Stub 3-wire SPI controller with an emulated DS1302 (clock, burst, 31-byte RAM)");
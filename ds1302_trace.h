@@ -0,0 +1,37 @@
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM ds1302
+
+#if !defined(DS1302_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define DS1302_TRACE_H
+
+#include <linux/tracepoint.h>
+
+// 명령 바이트 하나 단위의 전송 (cmd bit0 = 1 이면 읽기, SPI 백엔드는 묶음 단위로 기록)
+TRACE_EVENT(ds1302_xfer,
+    TP_PROTO(u8 cmd, int len, int n, int ret, u64 dur_ns),
+    TP_ARGS(cmd, len, n, ret, dur_ns),
+    TP_STRUCT__entry(
+        __field(u8, cmd)
+        __field(int, len)
+        __field(int, n)
+        __field(int, ret)
+        __field(u64, dur_ns)
+    ),
+    TP_fast_assign(
+        __entry->cmd = cmd;
+        __entry->len = len;
+        __entry->n = n;
+        __entry->ret = ret;
+        __entry->dur_ns = dur_ns;
+    ),
+    TP_printk("reg=0x%02x %s len=%d batch=%d ret=%d dur_ns=%llu",
+              __entry->cmd & 0xFE, (__entry->cmd & 1) ? "read" : "write",
+              __entry->len, __entry->n, __entry->ret, __entry->dur_ns)
+);
+
+#endif
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#define TRACE_INCLUDE_FILE ds1302_trace
+#include <trace/define_trace.h>
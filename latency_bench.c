@@ -0,0 +1,155 @@
+// 입력 -> 화면 지연 벤치마크 (gpio-sim + oled_i2c_stub 필요, latency_bench.sh 참고)
+//
+//   gcc -O2 -o latency_bench latency_bench.c
+//   sudo ./latency_bench -c /sys/devices/platform/gpio-sim.0/gpiochip2 -n 200 -l irq/flush0
+//
+// gpio-sim 라인(0: S1, 1: S2, 2: SW)을 움직여 엔코더 한 칸을 만들고, 앱이 그린
+// "INPUT: n" 숫자 칸 데이터가 oled_i2c_stub에 도착한 시각까지를 잰다.
+// 앱(main.c)은 그대로 실행 중이어야 하며, 메뉴 화면에서 시작한다.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+#define STUB_LOG "/sys/kernel/debug/oled_stub/log"
+#define STUB_CLR "/sys/kernel/debug/oled_stub/clear"
+
+enum { LINE_S1, LINE_S2, LINE_SW };
+
+static const char *chip_dir;
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void sleep_ms(int ms)
+{
+    usleep(ms * 1000);
+}
+
+static void write_str(const char *path, const char *s)
+{
+    int fd = open(path, O_WRONLY);
+    if (fd < 0) { perror(path); exit(1); }
+    write(fd, s, strlen(s));
+    close(fd);
+}
+
+// gpio-sim 라인 레벨 = pull 설정 (엔코더/버튼은 active low)
+static void set_line(int line, int level)
+{
+    char path[256];
+
+    snprintf(path, sizeof(path), "%s/sim_gpio%d/pull", chip_dir, line);
+    write_str(path, level ? "pull-up" : "pull-down");
+}
+
+static int cmp_ll(const void *a, const void *b)
+{
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char *label, long long *v, int n, int missed)
+{
+    if (n == 0) {
+        printf("%-14s (no samples, missed=%d)\n", label, missed);
+        return;
+    }
+    qsort(v, n, sizeof(*v), cmp_ll);
+    printf("%-14s n=%-5d missed=%-3d p50=%8.1f  p99=%8.1f  max=%8.1f us\n", label, n, missed,
+           v[n / 2] / 1000.0, v[(n * 99) / 100] / 1000.0, v[n - 1] / 1000.0);
+}
+
+int main(int argc, char **argv)
+{
+    const char *label = "latency";
+    int n = 200, interval = 150, opt;
+    long long *edge, *lat, ts;
+    long long *hits;
+    int n_hits = 0, cap_hits = 1024, n_lat = 0, missed = 0;
+    unsigned int page, x0, x1;
+    FILE *fp;
+
+    while ((opt = getopt(argc, argv, "c:n:i:l:")) != -1) {
+        if (opt == 'c') chip_dir = optarg;
+        else if (opt == 'n') n = atoi(optarg);
+        else if (opt == 'i') interval = atoi(optarg);
+        else if (opt == 'l') label = optarg;
+        else break;
+    }
+    // 디바운스(50ms)보다 간격이 짧으면 칸이 무시됨
+    if (!chip_dir || n <= 0 || interval < 60) {
+        fprintf(stderr, "usage: %s -c <gpio-sim chip dir> [-n steps] [-i interval_ms>=60] [-l label]\n", argv[0]);
+        return 1;
+    }
+    // 게임 한 판(60초) 안에 끝나야 함
+    if ((long long)n * interval > 55000) {
+        fprintf(stderr, "n * interval must fit in one 60 s game\n");
+        return 1;
+    }
+
+    edge = calloc(n, sizeof(*edge));
+    lat = calloc(n, sizeof(*lat));
+    hits = malloc(cap_hits * sizeof(*hits));
+    if (!edge || !lat || !hits) { perror("alloc"); return 1; }
+
+    // 대기 상태: 모두 High
+    set_line(LINE_S1, 1);
+    set_line(LINE_S2, 1);
+    set_line(LINE_SW, 1);
+    sleep_ms(200);
+
+    // 메뉴 커서가 START GAME일 때 짧게 눌러 게임 시작
+    set_line(LINE_SW, 0);
+    sleep_ms(100);
+    set_line(LINE_SW, 1);
+    sleep_ms(500);
+
+    write_str(STUB_CLR, "1");
+
+    // 한 칸씩 +1/-1 번갈아: 값이 0/100 끝에 걸려 화면이 안 바뀌는 일이 없게
+    for (int i = 0; i < n; i++) {
+        set_line(LINE_S2, !(i & 1));
+        sleep_ms(5);
+        edge[i] = now_ns();
+        set_line(LINE_S1, 0);
+        sleep_ms(10);
+        set_line(LINE_S1, 1);
+        sleep_ms(interval - 15);
+    }
+
+    // 길게 눌러 메뉴로 복귀 (다음 측정 준비)
+    set_line(LINE_SW, 0);
+    sleep_ms(1300);
+    set_line(LINE_SW, 1);
+
+    fp = fopen(STUB_LOG, "r");
+    if (!fp) { perror(STUB_LOG); return 1; }
+    while (fscanf(fp, "%lld %u %u %u", &ts, &page, &x0, &x1) == 4) {
+        if (n_hits == cap_hits) {
+            cap_hits *= 2;
+            hits = realloc(hits, cap_hits * sizeof(*hits));
+            if (!hits) { perror("alloc"); return 1; }
+        }
+        hits[n_hits++] = ts;
+    }
+    fclose(fp);
+
+    // 각 칸마다 다음 칸 전까지 처음 도착한 숫자 칸 데이터
+    for (int i = 0, j = 0; i < n; i++) {
+        long long limit = (i + 1 < n) ? edge[i + 1] : 0x7fffffffffffffffLL;
+
+        while (j < n_hits && hits[j] < edge[i]) j++;
+        if (j < n_hits && hits[j] < limit) lat[n_lat++] = hits[j] - edge[i];
+        else missed++;
+    }
+
+    report(label, lat, n_lat, missed);
+    return 0;
+}
@@ -0,0 +1,119 @@
+#!/bin/sh
+# 입력 -> 화면 지연 벤치마크 (하드웨어 없이)
+#
+#   make && gcc -O2 -pthread -o safe main.c && gcc -O2 -o latency_bench latency_bench.c
+#   sudo ./latency_bench.sh [steps]
+#   sudo ./latency_bench.sh [steps] rt     # 실시간 설정 비교 (stress-ng 필요)
+#
+# gpio-sim으로 엔코더/버튼/DS1302 라인을 만들고, OLED는 oled_i2c_stub 버스에,
+# 부저는 pwm_mock에 붙인 뒤 앱을 그대로 실행한다.
+# 기본: 로터리 입력 방식(IRQ / 1ms 폴링) x OLED flush_mode(0/1/2) 조합마다 p50/p99/max 출력.
+# rt: (기본 / rotary rt_prio + 앱 --rt) x (부하 없음 / stress-ng) 조합마다
+#     입력 -> 화면 지연과 드라이버 히스토그램(에지 -> read, 에지 -> 칸 처리) 출력.
+set -e
+
+STEPS=${1:-200}
+MODE=${2:-flush}
+SIM=/sys/kernel/config/gpio-sim/safe_bench
+RT_CPU=$(($(nproc) - 1))
+
+cleanup() {
+    [ -n "$APP" ] && kill "$APP" 2>/dev/null || true
+    [ -n "$LOAD" ] && kill "$LOAD" 2>/dev/null || true
+    for m in safe_buzzer rotary_interupt oled_ssd1306 oled_i2c_stub ds1302 pwm_mock; do
+        rmmod $m 2>/dev/null || true
+    done
+    if [ -d $SIM ]; then
+        echo 0 > $SIM/live
+        rmdir $SIM/bank0 $SIM
+    fi
+}
+trap cleanup EXIT
+
+modprobe gpio-sim
+
+# 라인 0: S1, 1: S2, 2: SW, 3: CE, 4: CLK, 5: IO
+mkdir -p $SIM/bank0
+echo 6 > $SIM/bank0/num_lines
+echo 1 > $SIM/live
+DEV=$(cat $SIM/dev_name)
+CHIP=$(cat $SIM/bank0/chip_name)
+CHIP_DIR=/sys/devices/platform/$DEV/$CHIP
+BASE=$(grep "^$CHIP:" /sys/kernel/debug/gpio | sed 's/.*GPIOs \([0-9]*\)-.*/\1/')
+
+insmod pwm_mock.ko
+PWM=$(for c in /sys/class/pwm/pwmchip*; do
+    [ "$(basename "$(readlink -f "$c/device")")" = pwm-mock ] && basename "$c" | sed 's/pwmchip//'
+done)
+insmod ds1302.ko gpio_ce=$((BASE + 3)) gpio_clk=$((BASE + 4)) gpio_io=$((BASE + 5))
+insmod oled_i2c_stub.ko
+
+# safe_buzzer는 rotary_interupt의 notifier를 쓰므로 로터리 뒤에 올리고, 로터리보다 먼저 내린다
+rotary_up() {
+    insmod rotary_interupt.ko s1_gpio=$BASE s2_gpio=$((BASE + 1)) sw_gpio=$((BASE + 2)) "$@"
+    echo 1 > /sys/kernel/debug/safe_rotary/stats   # 히스토그램은 기본으로 꺼져 있음
+    insmod safe_buzzer.ko pwm_index=$PWM
+}
+
+rotary_down() {
+    rmmod safe_buzzer rotary_interupt
+}
+
+# 히스토그램 요약 줄 (count/avg) + 가장 느린 칸
+hist() {
+    f=/sys/kernel/debug/safe_rotary/$1
+    [ -f $f ] || return 0
+    printf "    %-20s %s, slowest bucket >= %s ns\n" "$1" "$(tail -1 $f)" \
+        "$(sed -n 's/^ *\([0-9]*\) ns :.*/\1/p' $f | tail -1)"
+}
+
+if [ "$MODE" = rt ]; then
+    insmod oled_ssd1306.ko flush_mode=2
+    for RT in 0 1; do
+        for STRESS in 0 1; do
+            if [ $RT = 1 ]; then
+                rotary_up rt_prio=90 rt_cpu=$RT_CPU
+                ./safe --rt --rt-cpu $RT_CPU > /dev/null &
+            else
+                rotary_up
+                ./safe > /dev/null &
+            fi
+            APP=$!
+            if [ $STRESS = 1 ]; then
+                stress-ng --cpu "$(nproc)" --io 2 --vm 2 --vm-bytes 128M --timeout 0 > /dev/null 2>&1 &
+                LOAD=$!
+            fi
+            sleep 1
+
+            [ $RT = 1 ] && L=rt || L=default
+            [ $STRESS = 1 ] && L=$L/stress || L=$L/idle
+            ./latency_bench -c "$CHIP_DIR" -n "$STEPS" -l "$L"
+            hist event_to_read_hist
+            hist edge_to_step_hist
+
+            if [ -n "$LOAD" ]; then kill $LOAD; wait $LOAD 2>/dev/null || true; LOAD=; fi
+            kill $APP; wait $APP 2>/dev/null || true
+            APP=
+            rotary_down
+        done
+    done
+    exit 0
+fi
+
+for POLL in 0 1; do
+    for FLUSH in 0 1 2; do
+        rotary_up poll_mode=$POLL
+        insmod oled_ssd1306.ko flush_mode=$FLUSH
+        ./safe > /dev/null &
+        APP=$!
+        sleep 1
+
+        [ $POLL = 1 ] && MODE=poll1ms || MODE=irq
+        ./latency_bench -c "$CHIP_DIR" -n "$STEPS" -l "$MODE/flush$FLUSH"
+
+        kill $APP; wait $APP 2>/dev/null || true
+        APP=
+        rmmod oled_ssd1306
+        rotary_down
+    done
+done
@@ -0,0 +1,185 @@
+// 하드웨어 무관 로직 마이크로벤치마크 (safe_logic.h, 아무 리눅스 PC에서 실행)
+//
+//   gcc -O2 -o logic_bench logic_bench.c
+//   ./logic_bench [-n iterations] > now.txt
+//   ./logic_bench -b before.txt       # 이전 결과와 비교 (20% 이상 느려지면 종료 코드 1)
+//
+// 드라이버와 앱이 쓰는 것과 같은 static inline 함수를 그대로 돌려 연산 1번당 ns를 출력한다.
+// 측정 전에 결과값이 맞는지 먼저 확인하고, 틀리면 측정하지 않고 종료한다.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "safe_logic.h"
+
+#define MAX_OPS 8
+
+struct op_result {
+    const char *name;
+    double ns;
+};
+
+static struct op_result results[MAX_OPS];
+static int n_results;
+static volatile unsigned long sink;  // 최적화로 루프가 사라지지 않게
+
+// 글리프 묶기용 가짜 폰트 (실제 비트맵과 관계없이 코드마다 다른 값)
+static unsigned char font[128][5];
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void record(const char *name, long long t0, long iters)
+{
+    results[n_results].name = name;
+    results[n_results].ns = (double)(now_ns() - t0) / iters;
+    n_results++;
+}
+
+static int check(void)
+{
+    unsigned long last = 0;
+    char line[22] = "TIME: 12:34:56  >OK<";
+    unsigned char out[sizeof(line) * SAFE_GLYPH_W];
+    int d;
+
+    for (d = 0; d < 100; d++) {
+        if (safe_bcd2dec(safe_dec2bcd(d)) != d || safe_dec2bcd(d) != ((d / 10) << 4 | d % 10)) {
+            fprintf(stderr, "bcd: %d\n", d);
+            return -1;
+        }
+    }
+    if (safe_rot_dir(1) != 1 || safe_rot_dir(0) != -1) {
+        fprintf(stderr, "rot_dir\n");
+        return -1;
+    }
+    // 디바운스 창 안은 무시, 카운터가 넘어가도 같은 판단
+    if (!safe_rot_accept(100, &last, 5) || safe_rot_accept(104, &last, 5) || !safe_rot_accept(105, &last, 5)) {
+        fprintf(stderr, "rot_accept\n");
+        return -1;
+    }
+    last = (unsigned long)-3;
+    if (safe_rot_accept(1, &last, 5) || !safe_rot_accept(2, &last, 5)) {
+        fprintf(stderr, "rot_accept wrap\n");
+        return -1;
+    }
+    if (safe_wrap_add_u8(23, 1, 23) != 0 || safe_wrap_add_u8(0, -1, 59) != 59 ||
+        safe_wrap_add_u8(10, -125, 59) != 5) {
+        fprintf(stderr, "wrap_add_u8\n");
+        return -1;
+    }
+    if (safe_glyph_pack((const unsigned char (*)[5])font, line, strlen(line), out) != strlen(line) * SAFE_GLYPH_W ||
+        memcmp(out, font['T'], 5) || out[5] != 0 || memcmp(out + 6, font['I'], 5)) {
+        fprintf(stderr, "glyph_pack\n");
+        return -1;
+    }
+    return 0;
+}
+
+static void run(long iters)
+{
+    const char *line = "TIME: 12:34:56  >OK<";   // 화면 한 줄 (20글자)
+    size_t len = strlen(line);
+    unsigned char out[32 * SAFE_GLYPH_W];
+    unsigned long last = 0, acc = 0;
+    long long t0;
+    long i;
+
+    t0 = now_ns();
+    for (i = 0; i < iters; i++)
+        acc += safe_bcd2dec((unsigned char)(i ^ acc));
+    record("bcd2dec", t0, iters);
+
+    t0 = now_ns();
+    for (i = 0; i < iters; i++)
+        acc += safe_dec2bcd((unsigned char)((i ^ acc) % 100));
+    record("dec2bcd", t0, iters);
+
+    // 에지 하나 처리 = 방향 + 디바운스 판단 (절반 정도 인정되도록 간격을 섞음)
+    t0 = now_ns();
+    for (i = 0; i < iters; i++)
+        acc += safe_rot_accept((unsigned long)i * 3, &last, (i & 1) ? 2 : 5) ? safe_rot_dir(i & 2) : 0;
+    record("rot_edge", t0, iters);
+
+    t0 = now_ns();
+    for (i = 0; i < iters; i++)
+        acc += safe_wrap_add_u8((unsigned char)(acc % 60), (int)(i % 7) - 3, 59);
+    record("wrap_add_u8", t0, iters);
+
+    t0 = now_ns();
+    for (i = 0; i < iters / 16; i++) {
+        acc += safe_glyph_pack((const unsigned char (*)[5])font, line, len, out);
+        acc += out[i % (len * SAFE_GLYPH_W)];
+    }
+    record("glyph_pack_line", t0, iters / 16);
+
+    sink = acc;
+}
+
+// 이전 결과 파일("이름 ns" 줄)과 비교
+static int compare(const char *path)
+{
+    char name[64];
+    double ns;
+    int i, slow = 0;
+    FILE *fp = fopen(path, "r");
+
+    if (!fp) {
+        perror(path);
+        return 1;
+    }
+    while (fscanf(fp, "%63s %lf", name, &ns) == 2) {
+        for (i = 0; i < n_results; i++) {
+            if (strcmp(results[i].name, name))
+                continue;
+            printf("%-16s %8.2f -> %8.2f ns/op (%+.0f%%)\n", name, ns, results[i].ns,
+                   ns > 0 ? (results[i].ns - ns) * 100 / ns : 0);
+            if (results[i].ns > ns * 1.2)
+                slow = 1;
+        }
+    }
+    fclose(fp);
+    return slow;
+}
+
+int main(int argc, char **argv)
+{
+    const char *baseline = NULL;
+    long iters = 20000000;
+    int opt, i, j;
+
+    while ((opt = getopt(argc, argv, "n:b:")) != -1) {
+        if (opt == 'n') iters = atol(optarg);
+        else if (opt == 'b') baseline = optarg;
+        else break;
+    }
+    if (iters < 16) {
+        fprintf(stderr, "usage: %s [-n iterations>=16] [-b baseline]\n", argv[0]);
+        return 1;
+    }
+
+    for (i = 0; i < 128; i++)
+        for (j = 0; j < 5; j++)
+            font[i][j] = (unsigned char)(i * 5 + j);
+
+    if (check()) {
+        fprintf(stderr, "result check failed\n");
+        return 1;
+    }
+
+    run(iters / 10);   // 예열
+    n_results = 0;
+    run(iters);
+
+    if (baseline)
+        return compare(baseline);
+    for (i = 0; i < n_results; i++)
+        printf("%-16s %8.2f\n", results[i].name, results[i].ns);
+    return 0;
+}
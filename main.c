@@ -1,3 +1,18 @@
+// 금고 게임 앱
+//   gcc -O2 -pthread -o safe main.c
+//
+// 스레드 구성 (서로는 lock-free SPSC 링 + eventfd로만 통신)
+//   input  : 로터리를 읽어 입력 이벤트 링에 넣음 (연출 중에도 멈추지 않음)
+//            /dev/safe_events가 있으면 회전/버튼/RTC 초 틱을 read 한 번에 묶어서 받음
+//   main   : 게임 로직과 화면 (OLED, RTC, 게임/연출 타이머)
+//   audio  : 소리 명령 링을 받아 부저 드라이버에 씀
+//
+// --rt [--rt-prio N] [--rt-cpu N]: 메모리 고정(mlockall), SCHED_FIFO, CPU 고정
+//   input = N, main/audio = N-1 (기본 N = 80, CPU = 마지막 CPU)
+// --selftest: 성공 연출을 바로 띄우고, 연출이 끝날 때까지 입력 링에 회전을 몰아 넣어
+//   하나도 버려지지 않는지 확인 (실패하면 종료 코드 1). 입력 스레드 대신 가짜 입력을 쓰므로
+//   로터리 없이 돌릴 수 있고, 장치는 평소처럼 열림 (safe_sim이나 /dev/null 링크로도 가능)
+#define _GNU_SOURCE   // sched_setaffinity, CPU_SET (--rt)
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,11 +21,40 @@
 #include <sys/ioctl.h>
 #include <time.h>
 #include <sys/time.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/resource.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 
 #define ROT_DEV  "/dev/safe_rotary"
 #define BUZ_DEV  "/dev/safe_buzzer"
 #define RTC_DEV  "/dev/ds1302"
 #define OLED_DEV "/dev/oled"
+#define EVT_DEV  "/dev/safe_events"
+
+// mmap 상태 페이지 (로터리 위치/버튼, RTC 시각)
+#include "safe_status.h"
+#include "safe_logic.h"
+#include "safe_events.h"
+
+// SAFE_DEV_PREFIX가 있으면 "/dev/" 대신 사용 (예: safe_sim의 /dev/sim_)
+static const char *dev_path(const char *dev)
+{
+    static char buf[4][128];
+    static int idx;
+    const char *prefix = getenv("SAFE_DEV_PREFIX");
+    char *b;
+
+    if (!prefix) return dev;
+    b = buf[idx++ & 3];
+    snprintf(b, sizeof(buf[0]), "%s%s", prefix, dev + strlen("/dev/"));
+    return b;
+}
 
 // ===== OLED ioctl 정의 =====
 #define OLED_IOC_MAGIC 'o'
@@ -27,13 +71,150 @@ struct ds1302_time { unsigned char y, m, d, w, h, min, s; };
 #define RTC_GET _IOR('d', 0, struct ds1302_time)
 #define RTC_SET _IOW('d', 1, struct ds1302_time)
 
+// ===== Buzzer 음 시퀀스 정의 =====
+struct buz_note {
+    unsigned short freq_hz;   // 0 = 쉼표
+    unsigned char  duty_pct;  // 0이면 50%
+    unsigned char  rsvd;
+    unsigned short dur_ms;
+    unsigned short gap_ms;
+};
+struct buz_policy { unsigned char prio, policy; unsigned short rsvd; };
+enum { BUZ_POLICY_QUEUE, BUZ_POLICY_PREEMPT, BUZ_POLICY_DROP_IF_BUSY };
+struct buz_prox {
+    short target, value, min, max;
+    unsigned short range, base_ms, step_ms, beep_ms;
+};
+#define BUZ_IOC_WAIT       _IO('b', 0)
+#define BUZ_IOC_SET_POLICY _IOW('b', 1, struct buz_policy)
+#define BUZ_IOC_PROX_SET   _IOW('b', 3, struct buz_prox)
+#define BUZ_IOC_PROX_OFF   _IO('b', 4)
+
+// 소리 우선순위: 근접 힌트 < 조작음 < 성공 멜로디
+enum { PRIO_HINT, PRIO_EVENT, PRIO_MELODY };
+
 // fd
 int rot_fd;
-int buz_fd;
+int evt_fd = -1; // /dev/safe_events (없으면 rot_fd + RTC 타이머 사용)
+int buz_fd;   // 조작음 (선점)
+int hint_fd;  // 근접 힌트 (재생 중이면 버림)
+int mel_fd;   // 성공 멜로디 (최우선 선점)
 int oled_fd;
+int rtc_fd;
+int game_tfd; // 게임 1초 틱
+int rtc_tfd;  // RTC 초 경계 확인
+int fx_tfd;   // 연출 프레임 (WRONG!, 폭죽)
+int in_efd;   // input -> main 알림
+int aud_efd;  // main -> audio 알림
+
+// 이벤트 루프
+int dirty = 1;        // 화면을 다시 그려야 함
+long wakeups = 0;     // epoll_wait에서 깨어난 횟수 (--stats)
+
+// ===== lock-free SPSC 링 =====
+// 생산자 스레드 하나가 head만, 소비자 스레드 하나가 tail만 씀. 크기는 2의 거듭제곱
+struct spsc {
+    _Atomic unsigned head;
+    _Atomic unsigned tail;
+    unsigned mask, esize;
+    unsigned char *buf;
+};
+
+static int spsc_init(struct spsc *r, unsigned cap, unsigned esize)
+{
+    r->buf = calloc(cap, esize);
+    if (!r->buf) return -1;
+    r->mask = cap - 1;
+    r->esize = esize;
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    return 0;
+}
+
+// 가득 차면 -1 (호출한 쪽에서 버린 개수를 셈)
+static int spsc_push(struct spsc *r, const void *e)
+{
+    unsigned h = atomic_load_explicit(&r->head, memory_order_relaxed);
+    unsigned t = atomic_load_explicit(&r->tail, memory_order_acquire);
+
+    if (h - t > r->mask) return -1;
+    memcpy(r->buf + (h & r->mask) * r->esize, e, r->esize);
+    atomic_store_explicit(&r->head, h + 1, memory_order_release);
+    return 0;
+}
+
+// 비어 있으면 -1
+static int spsc_pop(struct spsc *r, void *e)
+{
+    unsigned t = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    unsigned h = atomic_load_explicit(&r->head, memory_order_acquire);
+
+    if (h == t) return -1;
+    memcpy(e, r->buf + (t & r->mask) * r->esize, r->esize);
+    atomic_store_explicit(&r->tail, t + 1, memory_order_release);
+    return 0;
+}
+
+// 입력 이벤트 (input -> main)
+enum { IN_STEP, IN_BTN_SHORT, IN_BTN_LONG, IN_RTC_TICK };
+struct in_event { int type; int delta; };   // IN_RTC_TICK: delta = 하루 중 초
+#define IN_RING_LEN 256
+
+// 소리 명령 (main -> audio)
+enum { AUD_BEEP, AUD_STOP, AUD_DOUBLE_BEEP, AUD_PROX_SET, AUD_PROX_OFF, AUD_SUCCESS };
+struct aud_cmd { int op; short a, b; };
+#define AUD_RING_LEN 64
+
+struct spsc in_ring, aud_ring;
+atomic_long in_events, in_dropped, aud_dropped;
+
+// ===== --profile: 호출 종류별 소요 시간 히스토그램 =====
+// 버킷 k = [2^k, 2^(k+1)) ns. 고정 크기라 측정 중에는 할당이 없음.
+// 종류마다 기록하는 스레드는 하나지만 요약은 main 스레드가 읽으므로 atomic 사용
+enum { PF_OLED_STR, PF_OLED_CLS, PF_BUZZER, PF_RTC_GET, PF_ROT_READ, PF_COUNT };
+static const char *pf_name[PF_COUNT] = { "oled_str", "oled_cls", "buzzer", "rtc_get", "rot_read" };
+#define PF_BUCKETS 40
+
+struct pf_hist {
+    atomic_long cnt;
+    atomic_long total_ns;
+    atomic_long bucket[PF_BUCKETS];
+};
+
+struct pf_hist prof[PF_COUNT];
+int profiling = 0;
+
+static long long now_ns(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+static inline long long pf_begin(void)
+{
+    return profiling ? now_ns() : 0;
+}
+
+static void pf_end(int type, long long t0)
+{
+    struct pf_hist *h = &prof[type];
+    long long d;
+    int k;
+
+    if (!profiling) return;
+    d = now_ns() - t0;
+    if (d < 1) d = 1;
+    k = 63 - __builtin_clzll((unsigned long long)d);
+    if (k >= PF_BUCKETS) k = PF_BUCKETS - 1;
+
+    atomic_fetch_add_explicit(&h->cnt, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->total_ns, d, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->bucket[k], 1, memory_order_relaxed);
+}
 
 // 상태 정의
-enum { STATE_MENU, STATE_GAME, STATE_SETTING };
+enum { STATE_MENU, STATE_GAME, STATE_SETTING, STATE_SUCCESS };
 int current_state = STATE_MENU;
 int menu_cursor = 0;
 
@@ -41,25 +222,67 @@ int menu_cursor = 0;
 int current_val = 50, time_left = 60;
 int targets[4];
 int stage = 0;
-int game_clear = 0;
-long last_beep_interval = 0;
 
 // 설정 변수
 int setting_step = 0;
 struct ds1302_time temp_time;
 
+// 메뉴 시계
+struct ds1302_time cur_time;
+int p_sec = -1;
+
+// 메뉴에서 이 시간 동안 입력이 없으면 화면을 지우고 시계 갱신을 멈춤.
+// 그래야 OLED 드라이버의 autosuspend가 패널과 차지 펌프를 끌 수 있다. 다음 입력은 깨우기만 함
+#define MENU_IDLE_MS 60000
+long last_input_ms;
+int menu_idle;
+
+// 단조 시계 (RTC_SET 등으로 벽시계가 바뀌어도 흔들리지 않음)
 long get_ms() {
-    struct timeval t;
-    gettimeofday(&t, NULL);
-    return (t.tv_sec * 1000) + (t.tv_usec / 1000);
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (t.tv_sec * 1000) + (t.tv_nsec / 1000000);
+}
+
+// 소리 명령 보내기: 링에 넣고 audio 스레드를 깨움 (main 스레드는 절대 안 기다림)
+static void aud_send(int op, int a, int b)
+{
+    struct aud_cmd c = { op, (short)a, (short)b };
+
+    if (spsc_push(&aud_ring, &c) < 0) {
+        atomic_fetch_add(&aud_dropped, 1);
+        return;
+    }
+    eventfd_write(aud_efd, 1);
+}
+
+void beep(int ms) { aud_send(AUD_BEEP, ms, 0); }
+void stop_beep() { aud_send(AUD_STOP, 0, 0); }
+// 같은 음 두 번 (간격 gap ms)
+void double_beep(int ms, int gap) { aud_send(AUD_DOUBLE_BEEP, ms, gap); }
+
+static void timer_arm(int tfd, long first_ms, long period_ms)
+{
+    struct itimerspec its = {
+        { period_ms / 1000, (period_ms % 1000) * 1000000L },
+        { first_ms / 1000, (first_ms % 1000) * 1000000L },
+    };
+    timerfd_settime(tfd, 0, &its, NULL);   // first_ms = 0 이면 해제
 }
 
-void beep(int ms) { write(buz_fd, &ms, sizeof(int)); }
-void stop_beep() { int z = 0; write(buz_fd, &z, sizeof(int)); }
+// 우선순위/정책이 정해진 부저 fd 열기
+static int buz_open(int prio, int policy)
+{
+    struct buz_policy p = { (unsigned char)prio, (unsigned char)policy, 0 };
+    int fd = open(dev_path(BUZ_DEV), O_WRONLY);
+
+    if (fd >= 0) ioctl(fd, BUZ_IOC_SET_POLICY, &p);
+    return fd;
+}
 
 static void oled_init_drv(void)
 {
-    oled_fd = open(OLED_DEV, O_RDWR);
+    oled_fd = open(dev_path(OLED_DEV), O_RDWR);
     if (oled_fd < 0) {
         perror("OLED open fail");
         exit(1);
@@ -67,9 +290,16 @@ static void oled_init_drv(void)
     ioctl(oled_fd, OLED_CLEAR);
 }
 
+static void ui_invalidate(void);
+
+// 화면을 지우면 위젯 캐시도 같이 무효화 (화면 전환)
 static void oled_cls_drv(void)
 {
+    long long t0 = pf_begin();
+
     ioctl(oled_fd, OLED_CLEAR);
+    pf_end(PF_OLED_CLS, t0);
+    ui_invalidate();
 }
 
 static void oled_setpos_drv(int x, int page)
@@ -87,274 +317,897 @@ static void oled_setpos_drv(int x, int page)
 
 static void oled_str_drv(int x, int page, const char *s)
 {
+    long long t0 = pf_begin();
+
     oled_setpos_drv(x, page);
     write(oled_fd, s, strlen(s));
+    pf_end(PF_OLED_STR, t0);
 }
 
-// 성공음 
-static void success_sound(void)
+// ===== 상태 페이지 (seqlock) =====
+// 드라이버가 seq를 짝수로 되돌릴 때까지 기다렸다가 복사하고, 그 사이 바뀌었으면 다시 읽음
+static void status_read(const void *page, void *dst, size_t n)
 {
-    beep(80);  usleep(40 * 1000);
-    beep(80);  usleep(40 * 1000);
-    beep(120); usleep(60 * 1000);
-    beep(80);  usleep(40 * 1000);
-    beep(80);  usleep(40 * 1000);
-    beep(250); usleep(150 * 1000);
+    const _Atomic unsigned *seq = (const _Atomic unsigned *)page;
+    unsigned s;
+
+    do {
+        while ((s = atomic_load_explicit(seq, memory_order_acquire)) & 1)
+            ;
+        memcpy(dst, page, n);
+        atomic_thread_fence(memory_order_acquire);
+    } while (atomic_load_explicit(seq, memory_order_relaxed) != s);
 }
 
-static void fireworks_sound(void)
+const struct safe_rotary_status *rot_page;   // 매핑 실패 시 NULL (예: 시뮬레이터)
+const struct safe_rtc_status *rtc_page;      // 메뉴 화면에서만 매핑 (그동안 드라이버가 주기적으로 갱신)
+
+static void rtc_page_map(int on)
+{
+    if (on && !rtc_page) {
+        void *p = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, rtc_fd, 0);
+        if (p != MAP_FAILED) rtc_page = p;
+    } else if (!on && rtc_page) {
+        munmap((void *)rtc_page, sysconf(_SC_PAGESIZE));
+        rtc_page = NULL;
+    }
+}
+
+// /dev/safe_events의 RTC_TICK 구독 (메뉴 화면에서만 켬: 켜 둔 동안 드라이버가 DS1302를 주기적으로 읽음)
+static int rtc_ticks_on;     // 틱으로 시계 갱신 중 -> rtc_poll 타이머는 처음 한 번만
+
+// 구독에 성공하면 1. 실패하면 (RTC 없음, 예전 모듈) 호출한 쪽이 상태 페이지 + rtc_poll 타이머로 동작
+static int rtc_ticks(int on)
+{
+    __u32 mask = SAFE_EVT_MASK_DEFAULT;
+
+    if (on) mask |= SAFE_EVT_BIT(SAFE_EVT_RTC_TICK);
+    rtc_ticks_on = on && evt_fd >= 0 && ioctl(evt_fd, SAFE_EVT_IOC_SET_MASK, &mask) == 0;
+    if (!on && evt_fd >= 0) ioctl(evt_fd, SAFE_EVT_IOC_SET_MASK, &mask);
+    return rtc_ticks_on;
+}
+
+// 페이지가 매핑돼 있으면 시스템 콜 없이, 아니면 ioctl
+static int rtc_get(struct ds1302_time *t)
 {
+    long long t0;
+    int ret;
+
+    if (rtc_page) {
+        struct safe_rtc_status st;
+
+        status_read(rtc_page, &st, sizeof(st));
+        if (st.valid) {
+            t->y = st.year; t->m = st.month; t->d = st.date; t->w = st.dow;
+            t->h = st.hour; t->min = st.min; t->s = st.sec;
+            return 0;
+        }
+    }
+
+    t0 = pf_begin();
+    ret = ioctl(rtc_fd, RTC_GET, t);
+    pf_end(PF_RTC_GET, t0);
+    return ret;
+}
+
+// ===== 위젯 (retained mode) =====
+// 위치와 마지막으로 그린 문자열을 기억해 두고, 내용이 바뀐 위젯만 드라이버에 씀
+#define UI_TEXT_MAX 24
+
+struct widget {
+    unsigned char x, page;
+    char last[UI_TEXT_MAX];   // "" = 아직 안 그림 (화면 지운 직후)
+};
+
+enum {
+    W_CLOCK, W_TITLE, W_MENU_START, W_MENU_SET,                    // 메뉴
+    W_SET_TITLE, W_SET_H, W_SET_COL1, W_SET_M, W_SET_COL2, W_SET_S, // 설정
+    W_TIMER, W_SLOT0, W_SLOT1, W_SLOT2, W_SLOT3, W_INPUT,          // 게임
+    W_COUNT
+};
+
+static struct widget widgets[W_COUNT] = {
+    [W_CLOCK]      = { 10, 0 },
+    [W_TITLE]      = { 20, 2 },
+    [W_MENU_START] = { 10, 4 },
+    [W_MENU_SET]   = { 10, 6 },
+    [W_SET_TITLE]  = { 30, 2 },
+    [W_SET_H]      = { 20, 4 },
+    [W_SET_COL1]   = { 42, 4 },
+    [W_SET_M]      = { 55, 4 },
+    [W_SET_COL2]   = { 77, 4 },
+    [W_SET_S]      = { 90, 4 },
+    [W_TIMER]      = { 30, 0 },
+    [W_SLOT0]      = { 10, 3 },
+    [W_SLOT1]      = { 40, 3 },
+    [W_SLOT2]      = { 70, 3 },
+    [W_SLOT3]      = { 100, 3 },
+    [W_INPUT]      = { 30, 5 },
+};
+
+static void ui_invalidate(void)
+{
+    for (int i = 0; i < W_COUNT; i++) widgets[i].last[0] = '\0';
+}
+
+// 라벨: 바뀌었을 때만 출력. 이전보다 짧아지면 남는 글자는 공백으로 덮음
+static void ui_label(int id, const char *text)
+{
+    struct widget *w = &widgets[id];
+    char out[UI_TEXT_MAX];
+    int len, old;
+
+    if (!strcmp(w->last, text)) return;
+
+    len = snprintf(out, sizeof(out), "%s", text);
+    if (len >= UI_TEXT_MAX) len = UI_TEXT_MAX - 1;
+    old = strlen(w->last);
+    while (len < old) out[len++] = ' ';
+    out[len] = '\0';
+
+    oled_str_drv(w->x, w->page, out);
+    snprintf(w->last, sizeof(w->last), "%s", text);
+}
+
+// 숫자 필드
+static void ui_number(int id, const char *fmt, int v)
+{
+    char buf[UI_TEXT_MAX];
+    snprintf(buf, sizeof(buf), fmt, v);
+    ui_label(id, buf);
+}
+
+// 커서 항목: 선택되면 '>' 표시
+static void ui_cursor(int id, int selected, const char *text)
+{
+    char buf[UI_TEXT_MAX];
+    snprintf(buf, sizeof(buf), "%c %s", selected ? '>' : ' ', text);
+    ui_label(id, buf);
+}
+
+// 근접 비프: 다음 정답과 현재값을 넘기면 간격(dist*40+100ms)은 드라이버가
+// 로터리 위치를 따라가며 직접 만든다. 앱은 값이 어긋날 때만 다시 맞춰 줌
+static void prox_sync(void)
+{
+    if (stage < 4) aud_send(AUD_PROX_SET, targets[stage], current_val);
+    else aud_send(AUD_PROX_OFF, 0, 0);
+}
+
+static void prox_stop(void)
+{
+    aud_send(AUD_PROX_OFF, 0, 0);
+}
+
+// ===== audio 스레드 =====
+// 성공음 + 폭죽음: 한 번의 write로 전체 멜로디를 넘김
+static void success_sound(void)
+{
+    static const struct buz_note jingle[] = {
+        { 1047, 50, 0, 80, 40 },  { 1319, 50, 0, 80, 40 },  { 1568, 50, 0, 120, 60 },
+        { 1319, 50, 0, 80, 40 },  { 1568, 50, 0, 80, 40 },  { 2093, 50, 0, 250, 150 },
+    };
+    struct buz_note seq[6 + 3 * 12];
+    int n = 6;
+
+    memcpy(seq, jingle, sizeof(jingle));
+
+    // 폭죽: 짧은 음 12개 x 3회, 회차 사이 120ms 쉼
     for (int r = 0; r < 3; r++) {
         for (int i = 0; i < 12; i++) {
-            beep(25);
-            usleep(15 * 1000);
+            struct buz_note p = { (unsigned short)(1500 + i * 80), 50, 0, 25, 15 };
+            if (i == 11) p.gap_ms += 120;
+            seq[n++] = p;
         }
-        usleep(120 * 1000);
     }
-    stop_beep();
+    write(mel_fd, seq, n * sizeof(*seq));
 }
 
-static void fireworks_oled(void)
+static void aud_exec(const struct aud_cmd *c)
 {
-    oled_cls_drv();
+    long long t0 = pf_begin();
+    int ms = c->a;
 
-    // 중앙 정렬 텍스트
-    oled_str_drv(22, 1, "SAFE UNLOCKED!");
-    oled_str_drv(34, 3, "CONGRATS!!");
+    switch (c->op) {
+    case AUD_BEEP:
+        write(buz_fd, &ms, sizeof(int));
+        break;
+    case AUD_STOP:
+        ms = 0;
+        write(buz_fd, &ms, sizeof(int));
+        break;
+    case AUD_DOUBLE_BEEP: {
+        // 두 음을 한 번에 넘겨 간격도 드라이버 타이머가 맞춤
+        struct buz_note n[2] = {
+            { 1000, 50, 0, (unsigned short)c->a, (unsigned short)c->b },
+            { 1000, 50, 0, (unsigned short)c->a, 0 },
+        };
+        write(buz_fd, n, sizeof(n));
+        break;
+    }
+    case AUD_PROX_SET: {
+        struct buz_prox p = { c->a, c->b, 0, 100, 40, 100, 40, 30 };
+        ioctl(hint_fd, BUZ_IOC_PROX_SET, &p);
+        break;
+    }
+    case AUD_PROX_OFF:
+        ioctl(hint_fd, BUZ_IOC_PROX_OFF);
+        break;
+    case AUD_SUCCESS:
+        success_sound();
+        break;
+    }
+    pf_end(PF_BUZZER, t0);
+}
 
-    for (int i = 0; i < 6; i++) {
-        oled_str_drv(25, 5, "*** BOOM ***");
-        usleep(120 * 1000);
-        oled_str_drv(25, 5, "             "); 
-        usleep(120 * 1000);
+static void *audio_thread(void *arg)
+{
+    struct aud_cmd c;
+    eventfd_t cnt;
+
+    (void)arg;
+    while (1) {
+        if (eventfd_read(aud_efd, &cnt) < 0) continue;
+        while (spsc_pop(&aud_ring, &c) == 0) aud_exec(&c);
     }
+    return NULL;
 }
 
-static void success_show(void)
+// ===== input 스레드 =====
+// 로터리 값은 절대값이므로 여기서 변화량으로 바꿔 넘김
+// 입력 링에 하나 넣기 (알림은 호출하는 쪽에서). 넣었으면 1
+static int in_push(int type, int delta)
 {
-    success_sound();
-    fireworks_oled();
-    fireworks_sound();
+    struct in_event ev = { type, delta };
+
+    atomic_fetch_add(&in_events, 1);
+    if (spsc_push(&in_ring, &ev) < 0) {
+        atomic_fetch_add(&in_dropped, 1);
+        return 0;
+    }
+    return 1;
 }
 
-// Safe unsigned char adjust helpers (time setting)
-static unsigned char wrap_add_u8(unsigned char base, int delta, int max_inclusive)
+// /dev/safe_events: 블로킹 read 한 번에 쌓인 이벤트를 전부 받고, 연속된 회전은 합쳐서 넣음
+static void input_from_events(void)
 {
-    int v = (int)base + delta;
-    int mod = max_inclusive + 1;
-    // C의 음수 % 처리 때문에 안전하게 보정
-    v %= mod;
-    if (v < 0) v += mod;
-    return (unsigned char)v;
+    struct safe_event evs[64];
+
+    while (1) {
+        long long t0 = pf_begin();
+        ssize_t n = read(evt_fd, evs, sizeof(evs));
+        int delta = 0, pushed = 0, type;
+
+        pf_end(PF_ROT_READ, t0);
+        if (n <= 0) continue;
+
+        for (int i = 0; i < n / (int)sizeof(evs[0]); i++) {
+            switch (evs[i].type) {
+            case SAFE_EVT_ROTARY:
+                delta += evs[i].value;
+                continue;
+            case SAFE_EVT_BTN_SHORT: type = IN_BTN_SHORT; break;
+            case SAFE_EVT_BTN_LONG:  type = IN_BTN_LONG; break;
+            case SAFE_EVT_RTC_TICK:  type = IN_RTC_TICK; break;
+            default: continue;   // 부저 완료 등은 앱에서 쓰지 않음
+            }
+            // 순서 유지: 버튼/틱 앞까지의 회전을 먼저 넣음
+            if (delta) pushed += in_push(IN_STEP, delta);
+            delta = 0;
+            pushed += in_push(type, type == IN_RTC_TICK ? evs[i].value : 0);
+        }
+        if (delta) pushed += in_push(IN_STEP, delta);
+        if (pushed) eventfd_write(in_efd, 1);
+    }
 }
 
-int main() {
-    int rtc, p_val = 0, first = 1, p_sec = -1;
-    long last_sec = 0;
+static void *input_thread(void *arg)
+{
+    struct pollfd pfd = { .fd = rot_fd, .events = POLLIN };
+    int p_val = 0, first = 1;
     char buf[32];
-    struct ds1302_time t;
 
-    // OLED
-    oled_init_drv();
+    (void)arg;
+    if (evt_fd >= 0) {
+        input_from_events();
+        return NULL;
+    }
+    while (1) {
+        int type = IN_STEP, delta = 0;
+        long long t0;
+        int n;
 
-    rot_fd = open(ROT_DEV, O_RDONLY);
-    if (rot_fd < 0) { perror("Rotary open fail"); return 1; }
+        if (poll(&pfd, 1, -1) <= 0) continue;
+        t0 = pf_begin();
+        n = read(rot_fd, buf, 31);
+        pf_end(PF_ROT_READ, t0);
+        if (n <= 0) continue;
+        buf[n] = 0;
+
+        if (!strncmp(buf, "BTN_LONG", 8)) type = IN_BTN_LONG;
+        else if (!strncmp(buf, "BTN_SHORT", 9)) type = IN_BTN_SHORT;
+        else {
+            int curr = atoi(buf);
+            if (!first) delta = curr - p_val;
+            p_val = curr; first = 0;
+            if (delta == 0) continue;
+        }
 
-    buz_fd = open(BUZ_DEV, O_WRONLY);
-    if (buz_fd < 0) { perror("Buzzer open fail"); return 1; }
+        if (in_push(type, delta)) eventfd_write(in_efd, 1);
+    }
+    return NULL;
+}
 
-    rtc = open(RTC_DEV, O_RDWR);
-    if (rtc < 0) { perror("RTC open fail"); return 1; }
+// --selftest: 실제 로터리보다 훨씬 빠르게 (SELFTEST_US 간격) 회전을 넣는 가짜 input 스레드
+#define SELFTEST_US 100
+atomic_int selftest_run;
 
-    srand(time(NULL));
+static void *selftest_thread(void *arg)
+{
+    struct timespec next;
+    int dir = 1;
 
-    while (1) {
-        long now = get_ms();
-        int n = read(rot_fd, buf, 31);
-        int delta = 0, btn_s = 0, btn_l = 0;
-
-        if (n > 0) {
-            buf[n] = 0;
-            if (!strncmp(buf, "BTN_LONG", 8)) btn_l = 1;
-            else if (!strncmp(buf, "BTN_SHORT", 9)) btn_s = 1;
+    (void)arg;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (atomic_load(&selftest_run)) {
+        if (in_push(IN_STEP, dir)) eventfd_write(in_efd, 1);
+        dir = -dir;
+        next.tv_nsec += SELFTEST_US * 1000;
+        if (next.tv_nsec >= 1000000000) { next.tv_nsec -= 1000000000; next.tv_sec++; }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+    return NULL;
+}
+
+// ===== 연출 (main 스레드, fx 타이머로 프레임 진행) =====
+enum { FX_NONE, FX_WRONG, FX_FIREWORKS };
+int fx_kind = FX_NONE;
+int fx_frame = 0;
+#define FW_FRAMES 12   // 120ms x 12 = BOOM 6회 깜빡임
+
+static void fx_cancel(void)
+{
+    timer_arm(fx_tfd, 0, 0);
+    fx_kind = FX_NONE;
+}
+
+static void fx_wrong(void)
+{
+    oled_str_drv(30, 6, "WRONG!");
+    fx_kind = FX_WRONG;
+    timer_arm(fx_tfd, 200, 0);
+}
+
+static void success_show(void)
+{
+    current_state = STATE_SUCCESS;
+    oled_cls_drv();
+    aud_send(AUD_SUCCESS, 0, 0);
+
+    // 중앙 정렬 텍스트
+    oled_str_drv(22, 1, "SAFE UNLOCKED!");
+    oled_str_drv(34, 3, "CONGRATS!!");
+
+    fx_kind = FX_FIREWORKS;
+    fx_frame = 0;
+    timer_arm(fx_tfd, 1, 120);
+}
+
+// ===== 상태 전환 / 이벤트 처리 =====
+static void enter_menu(void)
+{
+    current_state = STATE_MENU;
+    menu_idle = 0;
+    last_input_ms = get_ms();
+    fx_cancel();
+    oled_cls_drv();
+    timer_arm(game_tfd, 0, 0);
+    p_sec = -1;
+    // 메뉴 시계는 RTC_TICK 이벤트 하나로, 안 되면 상태 페이지 + rtc_poll 타이머로
+    if (!rtc_ticks(1)) rtc_page_map(1);
+    timer_arm(rtc_tfd, 1, 0);   // 시계 즉시 갱신
+    dirty = 1;
+}
+
+static void start_game(void)
+{
+    current_state = STATE_GAME;
+    oled_cls_drv();
+    timer_arm(rtc_tfd, 0, 0);
+    rtc_ticks(0);
+    rtc_page_map(0);
+
+    printf("\n[DEBUG] Answers: ");
+    for (int i = 0; i < 4; i++) {
+        targets[i] = rand() % 101;
+        printf("%d ", targets[i]);
+    }
+    printf("\n");
+
+    current_val = 50;
+    time_left = 60;
+    stage = 0;
+    timer_arm(game_tfd, 1000, 1000);
+    prox_sync();
+    beep(50);
+}
+
+static void start_setting(void)
+{
+    current_state = STATE_SETTING;
+    oled_cls_drv();
+    timer_arm(rtc_tfd, 0, 0);
+    rtc_ticks(0);
+    rtc_page_map(0);
+    rtc_get(&temp_time);
+    setting_step = 0;
+    beep(50);
+}
+
+static void handle_input(int delta, int btn_s, int btn_l)
+{
+    // 메인 메뉴
+    if (current_state == STATE_MENU) {
+        if (delta > 0) menu_cursor = 1;
+        else if (delta < 0) menu_cursor = 0;
+
+        if (btn_s) {
+            if (menu_cursor == 0) start_game();
+            else start_setting();
+        }
+    }
+
+    // 설정 모드
+    else if (current_state == STATE_SETTING) {
+        if (delta != 0) {
+            if (setting_step == 0) {
+                temp_time.h = safe_wrap_add_u8(temp_time.h, delta, 23);
+            }
+            else if (setting_step == 1) {
+                temp_time.min = safe_wrap_add_u8(temp_time.min, delta, 59);
+            }
             else {
-                int curr = atoi(buf);
-                if (!first) delta = curr - p_val;
-                p_val = curr; first = 0;
+                temp_time.s = safe_wrap_add_u8(temp_time.s, delta, 59);
             }
         }
 
-        // 메인 메뉴
-        if (current_state == STATE_MENU) {
-            if (delta > 0) menu_cursor = 1;
-            else if (delta < 0) menu_cursor = 0;
-
-            if (btn_s) {
-                if (menu_cursor == 0) {
-                    current_state = STATE_GAME;
-                    oled_cls_drv();
-
-                    printf("\n[DEBUG] Answers: ");
-                    for (int i = 0; i < 4; i++) {
-                        targets[i] = rand() % 101;
-                        printf("%d ", targets[i]);
-                    }
-                    printf("\n");
-
-                    current_val = 50;
-                    time_left = 60;
-                    game_clear = 0;
-                    stage = 0;
-                    last_sec = now;
-                    last_beep_interval = now;
-                    beep(50);
-                } else {
-                    current_state = STATE_SETTING;
-                    oled_cls_drv();
-                    ioctl(rtc, RTC_GET, &temp_time);
-                    setting_step = 0;
-                    beep(50);
-                }
-                continue;
+        if (btn_s) {
+            setting_step++;
+            beep(50);
+            if (setting_step > 2) {
+                ioctl(rtc_fd, RTC_SET, &temp_time);
+                enter_menu();
+                return;
             }
+        }
+    }
 
-            if (rtc > 0 && ioctl(rtc, RTC_GET, &t) >= 0 && t.s != p_sec) {
-                snprintf(buf, 32, "TIME %02d:%02d:%02d", t.h, t.min, t.s);
-                oled_str_drv(10, 0, buf);
-                p_sec = t.s;
-            }
+    // 게임 모드
+    else if (current_state == STATE_GAME) {
+        if (btn_l) {
+            prox_stop();
+            stop_beep();
+            enter_menu();
+            return;
+        }
 
-            oled_str_drv(20, 2, "[ UNLOCK SAFE ]");
-            oled_str_drv(10, 4, menu_cursor == 0 ? "> START GAME" : "  START GAME");
-            oled_str_drv(10, 6, menu_cursor == 1 ? "> SETTINGS  " : "  SETTINGS  ");
+        if (delta != 0) {
+            int raw = current_val + delta;
+            current_val = raw;
+            if (current_val < 0) current_val = 0;
+            if (current_val > 100) current_val = 100;
+            // 끝에 걸려 잘린 경우 드라이버 쪽 값과 다시 맞춤
+            if (current_val != raw) prox_sync();
         }
 
-        // 설정 모드
-        else if (current_state == STATE_SETTING) {
-            if (delta != 0) {
-                if (setting_step == 0) {
-                    temp_time.h = wrap_add_u8(temp_time.h, delta, 23);
-                }
-                else if (setting_step == 1) {
-                    temp_time.min = wrap_add_u8(temp_time.min, delta, 59);
-                }
-                else {
-                    temp_time.s = wrap_add_u8(temp_time.s, delta, 59);
+        // 버튼 입력 처리
+        if (btn_s) {
+            if (current_val == targets[stage]) {
+                stage++;
+                prox_sync();
+                double_beep(100, 50);
+                if (stage >= 4) {
+                    // 성공 연출 후 메뉴로 자동 복귀 (fx 타이머가 진행)
+                    timer_arm(game_tfd, 0, 0);
+                    fx_cancel();
+                    success_show();
+                    return;
                 }
+            } else {
+                fx_wrong();
+                beep(200);
             }
+        }
+    }
+    dirty = 1;
+}
 
-            if (btn_s) {
-                setting_step++;
-                beep(50);
-                if (setting_step > 2) {
-                    ioctl(rtc, RTC_SET, &temp_time);
-                    current_state = STATE_MENU;
-                    oled_cls_drv();
-                    continue;
-                }
-            }
+// 게임 1초 틱 (밀린 만료 횟수만큼 한 번에 반영)
+static void game_tick(unsigned long long expired)
+{
+    if (current_state != STATE_GAME) return;
+
+    time_left -= (int)expired;
+    if (time_left <= 0) {
+        prox_stop();
+        stop_beep();
+        enter_menu();
+        return;
+    }
+    dirty = 1;
+}
+
+// 연출 프레임
+static void fx_tick(unsigned long long expired)
+{
+    if (fx_kind == FX_WRONG) {
+        fx_kind = FX_NONE;
+        if (current_state == STATE_GAME) oled_str_drv(30, 6, "      ");
+    }
+    else if (fx_kind == FX_FIREWORKS) {
+        fx_frame += (int)expired;
+        if (fx_frame > FW_FRAMES) {
+            enter_menu();
+            return;
+        }
+        oled_str_drv(25, 5, (fx_frame & 1) ? "*** BOOM ***" : "             ");
+    }
+}
+
+// 메뉴에서 입력 없이 MENU_IDLE_MS가 지났으면 화면을 비우고 RTC 갱신을 멈춤. 멈췄으면 1
+static int menu_idle_check(void)
+{
+    if (get_ms() - last_input_ms < MENU_IDLE_MS) return 0;
+
+    menu_idle = 1;
+    timer_arm(rtc_tfd, 0, 0);
+    rtc_ticks(0);
+    rtc_page_map(0);
+    oled_cls_drv();
+    dirty = 0;
+    return 1;
+}
+
+// RTC 초가 바뀌었는지 확인. 바뀐 직후에는 1초 가까이 쉬고,
+// 아직 안 바뀌었으면 짧게 다시 확인해서 초 경계에 맞춰 따라간다.
+
+static void rtc_poll(void)
+{
+    struct ds1302_time t;
+    int next = 20;
+
+    if (current_state != STATE_MENU || menu_idle) return;
+    if (menu_idle_check()) return;
+
+    if (rtc_get(&t) >= 0 && t.s != p_sec) {
+        cur_time = t;
+        p_sec = t.s;
+        dirty = 1;
+        next = 980;
+    }
+    // RTC_TICK을 구독했으면 이후 갱신은 이벤트로
+    if (!rtc_ticks_on) timer_arm(rtc_tfd, next, 0);
+}
 
-            oled_str_drv(30, 2, "SET TIME");
+// RTC_TICK 이벤트 (하루 중 초): DS1302를 다시 읽지 않고 시계만 갱신
+static void rtc_tick(int sec_of_day)
+{
+    // 끄기 전에 큐에 들어 있던 틱은 무시
+    if (current_state != STATE_MENU || menu_idle) return;
+    if (menu_idle_check()) return;
 
-            char h_str[16], m_str[16], s_str[16];
-            snprintf(h_str, sizeof(h_str), setting_step == 0 ? ">%02d" : " %02d", temp_time.h);
-            snprintf(m_str, sizeof(m_str), setting_step == 1 ? ">%02d" : " %02d", temp_time.min);
-            snprintf(s_str, sizeof(s_str), setting_step == 2 ? ">%02d" : " %02d", temp_time.s);
+    cur_time.h = sec_of_day / 3600;
+    cur_time.min = sec_of_day / 60 % 60;
+    cur_time.s = sec_of_day % 60;
+    p_sec = cur_time.s;
+    dirty = 1;
+}
 
-            oled_str_drv(20, 4, h_str);
-            oled_str_drv(42, 4, ":");
-            oled_str_drv(55, 4, m_str);
-            oled_str_drv(77, 4, ":");
-            oled_str_drv(90, 4, s_str);
+static void render(void)
+{
+    char buf[32];
+
+    // 메인 메뉴
+    if (current_state == STATE_MENU) {
+        if (p_sec >= 0) {
+            snprintf(buf, 32, "TIME %02d:%02d:%02d", cur_time.h, cur_time.min, cur_time.s);
+            ui_label(W_CLOCK, buf);
         }
 
-        // 게임 모드
-        else if (current_state == STATE_GAME) {
-            if (btn_l) {
-                stop_beep();
-                current_state = STATE_MENU;
-                oled_cls_drv();
-                continue;
-            }
+        ui_label(W_TITLE, "[ UNLOCK SAFE ]");
+        ui_cursor(W_MENU_START, menu_cursor == 0, "START GAME");
+        ui_cursor(W_MENU_SET, menu_cursor == 1, "SETTINGS");
+    }
 
-            if (game_clear) {
-                // 성공 연출은 1회만 실행하도록
-                success_show();
-                // 연출 후 메뉴로 자동 복귀
-                current_state = STATE_MENU;
-                oled_cls_drv();
-                stop_beep();
-                continue;
-            }
+    // 설정 모드
+    else if (current_state == STATE_SETTING) {
+        ui_label(W_SET_TITLE, "SET TIME");
+        ui_number(W_SET_H, setting_step == 0 ? ">%02d" : " %02d", temp_time.h);
+        ui_label(W_SET_COL1, ":");
+        ui_number(W_SET_M, setting_step == 1 ? ">%02d" : " %02d", temp_time.min);
+        ui_label(W_SET_COL2, ":");
+        ui_number(W_SET_S, setting_step == 2 ? ">%02d" : " %02d", temp_time.s);
+    }
 
-            if (delta != 0) {
-                current_val += delta;
-                if (current_val < 0) current_val = 0;
-                if (current_val > 100) current_val = 100;
-            }
+    // 게임 모드
+    else if (current_state == STATE_GAME) {
+        ui_number(W_TIMER, "TIMER: %02d", time_left);
 
-            if (now - last_sec >= 1000) {
-                time_left--;
-                last_sec = now;
-                if (time_left <= 0) {
-                    current_state = STATE_MENU;
-                    oled_cls_drv();
-                    stop_beep();
-                    continue;
-                }
-            }
+        // 목표 표시
+        for (int i = 0; i < 4; i++) {
+            if (i < stage) ui_number(W_SLOT0 + i, "%02d", targets[i]);
+            else ui_label(W_SLOT0 + i, "**");
+        }
 
-            // 화면 갱신
-            snprintf(buf, 32, "TIMER: %02d", time_left);
-            oled_str_drv(30, 0, buf);
-
-            // 목표 표시 
-            char tmp[8];
-            for (int i = 0; i < 4; i++) {
-                int x_pos = 10 + (i * 30);
-                if (i < stage) snprintf(tmp, sizeof(tmp), "%02d", targets[i]);
-                else snprintf(tmp, sizeof(tmp), "**");
-                oled_str_drv(x_pos, 3, tmp);
-            }
+        ui_number(W_INPUT, "INPUT: %-3d", current_val);
+    }
+    dirty = 0;
+}
 
-            snprintf(buf, 32, "INPUT: %-3d", current_val);
-            oled_str_drv(30, 5, buf);
-
-            // 버튼 입력 처리
-            if (btn_s) {
-                if (current_val == targets[stage]) {
-                    stage++;
-                    beep(100); usleep(50 * 1000); beep(100);
-                    if (stage >= 4) {
-                        game_clear = 1;   // 다음 루프에서 success_show()
-                        oled_cls_drv();
-                        continue;
-                    }
-                } else {
-                    oled_str_drv(30, 6, "WRONG!");
-                    beep(200);
-                    usleep(200 * 1000);
-                    oled_str_drv(30, 6, "      ");
-                }
-            }
+// --stats: 10초마다 초당 깨어난 횟수와 CPU 사용률 출력
+// 참고 (가짜 장치, x86): 메뉴 약 1.5회/s, 게임 1회/s. 예전 50ms read 루프는 상태와 관계없이 20회/s
+static void stats_report(void)
+{
+    static long last_ms, last_cpu_us, wakeups_prev;
+    long now = get_ms();
+    struct rusage ru;
+    long cpu_us;
 
-            // 근접 비프 (다음 정답 기준)
-            if (stage < 4) {
-                int dist = abs(targets[stage] - current_val);
-                if (dist > 0 && dist < 40) {
-                    int interval = dist * 40 + 100;
-                    if (now - last_beep_interval > interval) {
-                        beep(30);
-                        last_beep_interval = now;
-                    }
-                }
+    if (last_ms == 0) last_ms = now;
+    if (now - last_ms < 10000) return;
+
+    getrusage(RUSAGE_SELF, &ru);
+    cpu_us = ru.ru_utime.tv_sec * 1000000L + ru.ru_utime.tv_usec +
+             ru.ru_stime.tv_sec * 1000000L + ru.ru_stime.tv_usec;
+    printf("[STATS] state=%d wakeups/s=%.1f cpu=%.2f%% input=%ld dropped=%ld audio_dropped=%ld",
+           current_state,
+           (wakeups - wakeups_prev) * 1000.0 / (now - last_ms),
+           (cpu_us - last_cpu_us) / 10.0 / (now - last_ms),
+           atomic_load(&in_events), atomic_load(&in_dropped), atomic_load(&aud_dropped));
+    // 드라이버 쪽 이벤트 수: read() 한 번에 합쳐진 회전/버튼까지 포함
+    if (rot_page) {
+        struct safe_rotary_status st;
+        status_read(rot_page, &st, sizeof(st));
+        printf(" driver_events=%u", st.events);
+    }
+    printf("\n");
+    last_ms = now;
+    last_cpu_us = cpu_us;
+    wakeups_prev = wakeups;
+}
+
+// 히스토그램에서 분위수: 해당 버킷의 윗값 (us)
+static double pf_quantile(const long *b, long cnt, double q)
+{
+    long want = (long)(cnt * q), acc = 0;
+
+    for (int k = 0; k < PF_BUCKETS; k++) {
+        acc += b[k];
+        if (acc > want) return (double)(2LL << k) / 1000.0;
+    }
+    return 0;
+}
+
+// --profile: 10초마다 루프 속도, 종류별 p50/p99, 장치에 묶여 있던 시간 비율 출력 후 초기화
+static void profile_report(void)
+{
+    static long last_ms, wakeups_prev;
+    long now = get_ms(), span;
+
+    if (last_ms == 0) last_ms = now;
+    span = now - last_ms;
+    if (span < 10000) return;
+
+    printf("[PROFILE] %.1fs loop=%.1f/s\n", span / 1000.0,
+           (wakeups - wakeups_prev) * 1000.0 / span);
+    for (int i = 0; i < PF_COUNT; i++) {
+        struct pf_hist *h = &prof[i];
+        long b[PF_BUCKETS];
+        long cnt = atomic_exchange(&h->cnt, 0);
+        long total = atomic_exchange(&h->total_ns, 0);
+
+        for (int k = 0; k < PF_BUCKETS; k++) b[k] = atomic_exchange(&h->bucket[k], 0);
+        if (cnt == 0) continue;
+
+        printf("  %-9s n=%-6ld %7.1f/s  p50<%9.1fus  p99<%9.1fus  busy=%5.2f%%\n",
+               pf_name[i], cnt, cnt * 1000.0 / span,
+               pf_quantile(b, cnt, 0.50), pf_quantile(b, cnt, 0.99),
+               total / 1e4 / span);
+    }
+    last_ms = now;
+    wakeups_prev = wakeups;
+}
+
+static void epoll_add(int epfd, int fd)
+{
+    struct epoll_event ev = { .events = EPOLLIN, .data.fd = fd };
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        perror("epoll_ctl");
+        exit(1);
+    }
+}
+
+// --rt: 페이지 폴트와 다른 작업에 밀리지 않도록 메모리 고정 + SCHED_FIFO + CPU 고정.
+// 이후 만드는 스레드는 우선순위/CPU를 그대로 물려받음. 실패해도 경고만 하고 계속 실행
+static void rt_setup(int prio, int cpu)
+{
+    struct sched_param sp = { .sched_priority = prio - 1 };
+    cpu_set_t set;
+
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) perror("[RT] mlockall");
+
+    if (cpu < 0) cpu = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) < 0) perror("[RT] sched_setaffinity");
+
+    if (sched_setscheduler(0, SCHED_FIFO, &sp) < 0) perror("[RT] sched_setscheduler");
+    else printf("[RT] SCHED_FIFO input=%d main/audio=%d cpu=%d\n", prio, prio - 1, cpu);
+}
+
+// 입력 링 비우기 (연출 중에 들어온 이벤트도 여기서 전부 소비됨)
+static void drain_input(void)
+{
+    struct in_event ev;
+    eventfd_t cnt;
+
+    eventfd_read(in_efd, &cnt);
+    while (spsc_pop(&in_ring, &ev) == 0) {
+        if (ev.type == IN_RTC_TICK) {
+            rtc_tick(ev.delta);
+            continue;
+        }
+        last_input_ms = get_ms();
+        // 화면이 꺼져 있던 메뉴: 이 입력은 깨우기에만 씀
+        if (menu_idle) {
+            enter_menu();
+            continue;
+        }
+        handle_input(ev.type == IN_STEP ? ev.delta : 0,
+                     ev.type == IN_BTN_SHORT, ev.type == IN_BTN_LONG);
+    }
+}
+
+int main(int argc, char **argv) {
+    int epfd, show_stats = 0, rt_prio = 0, rt_cpu = -1, selftest = 0;
+    long long st_t0 = 0;
+    pthread_t in_th, aud_th;
+
+    for (int i = 1; i < argc; i++)
+        if (!strcmp(argv[i], "--stats")) show_stats = 1;
+        else if (!strcmp(argv[i], "--profile")) profiling = 1;
+        else if (!strcmp(argv[i], "--rt")) { if (!rt_prio) rt_prio = 80; }
+        else if (!strcmp(argv[i], "--rt-prio") && i + 1 < argc) rt_prio = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--rt-cpu") && i + 1 < argc) rt_cpu = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--selftest")) selftest = 1;
+    if (rt_prio < 0 || rt_prio > 99) rt_prio = 80;
+    if (rt_prio == 1) rt_prio = 2;   // main/audio는 N-1 (최소 1)
+
+    // OLED
+    oled_init_drv();
+
+    rot_fd = open(dev_path(ROT_DEV), O_RDONLY | O_NONBLOCK);
+    if (rot_fd < 0) { perror("Rotary open fail"); return 1; }
+    // 선택: safe_events 모듈이 올라와 있으면 입력/RTC 틱을 이쪽으로 받음
+    evt_fd = open(dev_path(EVT_DEV), O_RDONLY | O_CLOEXEC);
+    {
+        void *p = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, rot_fd, 0);
+        if (p != MAP_FAILED) rot_page = p;
+    }
+
+    buz_fd = buz_open(PRIO_EVENT, BUZ_POLICY_PREEMPT);
+    hint_fd = buz_open(PRIO_HINT, BUZ_POLICY_DROP_IF_BUSY);
+    mel_fd = buz_open(PRIO_MELODY, BUZ_POLICY_PREEMPT);
+    if (buz_fd < 0 || hint_fd < 0 || mel_fd < 0) { perror("Buzzer open fail"); return 1; }
+
+    rtc_fd = open(dev_path(RTC_DEV), O_RDWR);
+    if (rtc_fd < 0) { perror("RTC open fail"); return 1; }
+
+    // 게임 1초 틱, RTC 확인, 연출 프레임용 타이머 (CLOCK_MONOTONIC: RTC_SET에도 흔들리지 않음)
+    game_tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    rtc_tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    fx_tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (game_tfd < 0 || rtc_tfd < 0 || fx_tfd < 0) { perror("timerfd"); return 1; }
+
+    // 스레드 사이 링과 알림
+    in_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    aud_efd = eventfd(0, EFD_CLOEXEC);
+    if (in_efd < 0 || aud_efd < 0) { perror("eventfd"); return 1; }
+    if (spsc_init(&in_ring, IN_RING_LEN, sizeof(struct in_event)) < 0 ||
+        spsc_init(&aud_ring, AUD_RING_LEN, sizeof(struct aud_cmd)) < 0) {
+        perror("ring alloc");
+        return 1;
+    }
+
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) { perror("epoll"); return 1; }
+    epoll_add(epfd, in_efd);
+    epoll_add(epfd, game_tfd);
+    epoll_add(epfd, rtc_tfd);
+    epoll_add(epfd, fx_tfd);
+
+    if (rt_prio) rt_setup(rt_prio, rt_cpu);
+
+    atomic_store(&selftest_run, selftest);
+    if (pthread_create(&aud_th, NULL, audio_thread, NULL) ||
+        pthread_create(&in_th, NULL, selftest ? selftest_thread : input_thread, NULL)) {
+        fprintf(stderr, "thread create fail\n");
+        return 1;
+    }
+    // 입력 스레드만 한 단계 위: 연출/렌더링 중에도 로터리 read가 바로 돌도록
+    if (rt_prio) {
+        struct sched_param sp = { .sched_priority = rt_prio };
+        pthread_setschedparam(in_th, SCHED_FIFO, &sp);
+    }
+
+    srand(time(NULL));
+    enter_menu();
+    if (selftest) {
+        st_t0 = now_ns();
+        success_show();
+    }
+
+    // --selftest: 연출이 끝나 메뉴로 돌아오면 종료
+    while (!selftest || current_state == STATE_SUCCESS) {
+        struct epoll_event evs[4];
+        int nev;
+
+        if (dirty) render();
+
+        // 할 일이 생길 때까지 잠듦 (입력, 게임 틱, RTC 확인, 연출 프레임)
+        nev = epoll_wait(epfd, evs, 4, -1);
+        if (nev < 0) continue;
+        wakeups++;
+
+        for (int e = 0; e < nev; e++) {
+            int fd = evs[e].data.fd;
+            unsigned long long expired;
+
+            if (fd == in_efd) {
+                drain_input();
+            }
+            else if (fd == game_tfd) {
+                if (read(game_tfd, &expired, sizeof(expired)) == sizeof(expired))
+                    game_tick(expired);
+            }
+            else if (fd == rtc_tfd) {
+                if (read(rtc_tfd, &expired, sizeof(expired)) == sizeof(expired))
+                    rtc_poll();
+            }
+            else if (fd == fx_tfd) {
+                if (read(fx_tfd, &expired, sizeof(expired)) == sizeof(expired))
+                    fx_tick(expired);
             }
         }
+
+        if (show_stats) stats_report();
+        if (profiling) profile_report();
+    }
+
+    if (selftest) {
+        long dropped;
+
+        atomic_store(&selftest_run, 0);
+        pthread_join(in_th, NULL);
+        drain_input();
+        dropped = atomic_load(&in_dropped);
+        printf("[SELFTEST] fireworks %.0f ms, input=%ld (every %d us) dropped=%ld: %s\n",
+               (now_ns() - st_t0) / 1e6, atomic_load(&in_events), SELFTEST_US, dropped,
+               dropped ? "FAIL" : "OK");
+        return dropped ? 1 : 0;
     }
 
+    close(epfd);
+    close(game_tfd);
+    close(rtc_tfd);
+    close(fx_tfd);
+    close(in_efd);
+    close(aud_efd);
     close(rot_fd);
+    if (evt_fd >= 0) close(evt_fd);
     close(buz_fd);
-    close(rtc);
+    close(hint_fd);
+    close(mel_fd);
+    close(rtc_fd);
     close(oled_fd);
     return 0;
 }
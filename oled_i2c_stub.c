@@ -0,0 +1,234 @@
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/i2c.h>
+#include <linux/ktime.h>
+#include <linux/delay.h>
+#include <linux/spinlock.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+
+// 입력 -> 화면 지연 측정용 가짜 I2C 버스 + SSD1306.
+// oled_ssd1306 드라이버를 이 버스(0x3C)에 붙여 두고, 화면의 감시 영역
+// (기본: "INPUT: n"의 숫자 칸, page 5 / x 72~89)에 데이터가 써질 때마다
+// 전송이 끝난 시각(ktime)을 기록한다.
+//   /sys/kernel/debug/oled_stub/log   : "ts_ns page x0 x1" 한 줄씩
+//   /sys/kernel/debug/oled_stub/clear : 아무 값이나 쓰면 기록 초기화
+//   /sys/kernel/debug/oled_stub/bytes : 지금까지 받은 전체 바이트 수
+
+#define STUB_ADDR    0x3C
+#define STUB_LOG_LEN 8192
+
+// 버스 속도 흉내 (바이트당 9클럭, 0이면 지연 없음)
+static int bus_khz = 400;
+module_param(bus_khz, int, 0444);
+MODULE_PARM_DESC(bus_khz, "simulated I2C clock in kHz (0 = no bus delay)");
+
+// 감시 영역
+static int watch_page = 5;
+static int watch_x0 = 72;
+static int watch_x1 = 90;
+module_param(watch_page, int, 0444);
+module_param(watch_x0, int, 0444);
+module_param(watch_x1, int, 0444);
+
+struct stub_evt {
+    u64 ts_ns;
+    u8 page;
+    u8 x0, x1;   // 이번 전송에서 감시 영역에 써진 열 범위
+};
+
+static struct stub_evt stub_log[STUB_LOG_LEN];
+static unsigned int stub_len;
+static unsigned int stub_lost;
+static u64 stub_bytes;
+static DEFINE_SPINLOCK(stub_lock);
+
+// SSD1306 주소 포인터 (page 주소 지정 방식만 흉내)
+static u8 cur_page, cur_col;
+
+static struct i2c_adapter stub_adap;
+static struct i2c_client *stub_client;
+static struct dentry *stub_debugfs;
+
+static void stub_cmd(u8 c)
+{
+    if ((c & 0xF8) == 0xB0) cur_page = c & 0x07;
+    else if ((c & 0xF0) == 0x00) cur_col = (cur_col & 0xF0) | (c & 0x0F);
+    else if ((c & 0xF0) == 0x10) cur_col = (cur_col & 0x0F) | ((c & 0x0F) << 4);
+}
+
+// 메시지 하나 해석: 제어 바이트 Co/DC 규칙대로 명령/데이터를 나눔.
+// 감시 영역에 데이터가 들어가면 그 열 범위를 돌려줌
+static bool stub_parse(const u8 *buf, int len, u8 *hit_x0, u8 *hit_x1)
+{
+    bool hit = false;
+    int i = 0;
+
+    while (i < len) {
+        u8 ctrl = buf[i++];
+        bool cont = ctrl & 0x80;    // Co: 1이면 바이트 하나 뒤에 다시 제어 바이트
+        bool data = ctrl & 0x40;    // D/C
+        int end = cont ? min(i + 1, len) : len;
+
+        for (; i < end; i++) {
+            if (!data) {
+                stub_cmd(buf[i]);
+                continue;
+            }
+            if (cur_page == watch_page && cur_col >= watch_x0 && cur_col < watch_x1) {
+                if (!hit) *hit_x0 = cur_col;
+                *hit_x1 = cur_col;
+                hit = true;
+            }
+            if (cur_col < 127) cur_col++;
+        }
+    }
+    return hit;
+}
+
+static int stub_xfer(struct i2c_adapter *adap, struct i2c_msg *msgs, int num)
+{
+    int i;
+
+    for (i = 0; i < num; i++) {
+        struct i2c_msg *m = &msgs[i];
+        u8 x0 = 0, x1 = 0;
+        unsigned long flags;
+        bool hit;
+
+        if (m->addr != STUB_ADDR)
+            return -ENXIO;
+        if (m->flags & I2C_M_RD) {
+            memset(m->buf, 0, m->len);
+            continue;
+        }
+
+        // 주소 1바이트 + 데이터, 바이트당 9클럭
+        if (bus_khz > 0)
+            fsleep(DIV_ROUND_UP((m->len + 1) * 9 * 1000, bus_khz));
+
+        hit = stub_parse(m->buf, m->len, &x0, &x1);
+
+        spin_lock_irqsave(&stub_lock, flags);
+        stub_bytes += m->len;
+        if (hit) {
+            if (stub_len < STUB_LOG_LEN) {
+                stub_log[stub_len].ts_ns = ktime_get_ns();
+                stub_log[stub_len].page = cur_page;
+                stub_log[stub_len].x0 = x0;
+                stub_log[stub_len].x1 = x1;
+                stub_len++;
+            } else {
+                stub_lost++;
+            }
+        }
+        spin_unlock_irqrestore(&stub_lock, flags);
+    }
+    return num;
+}
+
+static u32 stub_func(struct i2c_adapter *adap)
+{
+    return I2C_FUNC_I2C;
+}
+
+static const struct i2c_algorithm stub_algo = {
+    .master_xfer   = stub_xfer,
+    .functionality = stub_func,
+};
+
+// ---- debugfs ----
+static void *stub_seq_start(struct seq_file *m, loff_t *pos)
+{
+    return *pos < READ_ONCE(stub_len) ? &stub_log[*pos] : NULL;
+}
+
+static void *stub_seq_next(struct seq_file *m, void *v, loff_t *pos)
+{
+    (*pos)++;
+    return stub_seq_start(m, pos);
+}
+
+static void stub_seq_stop(struct seq_file *m, void *v)
+{
+}
+
+static int stub_seq_show(struct seq_file *m, void *v)
+{
+    const struct stub_evt *e = v;
+
+    seq_printf(m, "%llu %u %u %u\n", e->ts_ns, e->page, e->x0, e->x1);
+    return 0;
+}
+
+static const struct seq_operations stub_seq_ops = {
+    .start = stub_seq_start,
+    .next  = stub_seq_next,
+    .stop  = stub_seq_stop,
+    .show  = stub_seq_show,
+};
+DEFINE_SEQ_ATTRIBUTE(stub_seq);
+
+static ssize_t stub_clear_write(struct file *f, const char __user *u, size_t c, loff_t *o)
+{
+    unsigned long flags;
+
+    spin_lock_irqsave(&stub_lock, flags);
+    stub_len = 0;
+    stub_lost = 0;
+    stub_bytes = 0;
+    spin_unlock_irqrestore(&stub_lock, flags);
+    return c;
+}
+
+static const struct file_operations stub_clear_fops = {
+    .owner = THIS_MODULE,
+    .write = stub_clear_write,
+};
+
+static int __init oled_stub_init(void)
+{
+    struct i2c_board_info info = {
+        I2C_BOARD_INFO("oled_ssd1306_char", STUB_ADDR),
+    };
+    int ret;
+
+    stub_adap.owner = THIS_MODULE;
+    stub_adap.algo = &stub_algo;
+    strscpy(stub_adap.name, "oled-stub", sizeof(stub_adap.name));
+    ret = i2c_add_adapter(&stub_adap);
+    if (ret)
+        return ret;
+
+    // oled_ssd1306 모듈이 올라와 있으면 바로, 아니면 로드될 때 붙음
+    stub_client = i2c_new_client_device(&stub_adap, &info);
+    if (IS_ERR(stub_client)) {
+        i2c_del_adapter(&stub_adap);
+        return PTR_ERR(stub_client);
+    }
+
+    stub_debugfs = debugfs_create_dir("oled_stub", NULL);
+    debugfs_create_file("log", 0444, stub_debugfs, NULL, &stub_seq_fops);
+    debugfs_create_file("clear", 0200, stub_debugfs, NULL, &stub_clear_fops);
+    debugfs_create_u32("lost", 0444, stub_debugfs, &stub_lost);
+    debugfs_create_u64("bytes", 0444, stub_debugfs, &stub_bytes);
+
+    pr_info("oled_stub: i2c-%d, watching page %d x %d..%d\n",
+            stub_adap.nr, watch_page, watch_x0, watch_x1 - 1);
+    return 0;
+}
+
+static void __exit oled_stub_exit(void)
+{
+    debugfs_remove_recursive(stub_debugfs);
+    i2c_unregister_device(stub_client);
+    i2c_del_adapter(&stub_adap);
+}
+
+module_init(oled_stub_init);
+module_exit(oled_stub_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_AUTHOR("kkk");
+MODULE_DESCRIPTION("Stub I2C bus with a fake SSD1306 that timestamps writes to a watched screen area");
@@ -6,10 +6,32 @@
 #include <linux/ioctl.h>
 #include <linux/types.h>
 #include <linux/string.h> 
+#include <linux/pm_runtime.h>
+#include <linux/debugfs.h>
+
+#include "safe_hist.h"
+#include "safe_logic.h"
+
+#define CREATE_TRACE_POINTS
+#include "oled_trace.h"
 
 #define SSD1306_ADDR 0x3C
 #define OLED_IOC_MAGIC 'o'
 
+// 좌표 설정/데이터 전송 방식
+//   0: 명령마다 I2C 전송 1번 (좌표 설정 = 3번)
+//   1: 좌표 명령 3개를 전송 1번으로 묶음
+//   2: 좌표는 기억만 해 두고, 다음 문자 데이터 앞에 붙여 전송 1번으로 보냄
+static int flush_mode = 0;
+module_param(flush_mode, int, 0444);
+MODULE_PARM_DESC(flush_mode, "0: one transfer per command, 1: batched address commands, 2: address + data in one transfer");
+
+// 이 시간 동안 write/ioctl이 없으면 화면 끄기(0xAE) + 차지 펌프 끄기
+// (앱은 메뉴 시계를 1초마다 다시 그리므로, 입력이 없을 때 앱이 그리기를 멈춰야 꺼짐)
+static int autosuspend_ms = 30000;
+module_param(autosuspend_ms, int, 0444);
+MODULE_PARM_DESC(autosuspend_ms, "idle time in ms before the display and charge pump are switched off");
+
 // 공유 데이터 구조체 및 IOCTL 명령 정의 
 typedef struct {
     __u8 x;       // 0~127
@@ -46,17 +68,67 @@ static const unsigned char font5x7[128][5] = {
 // 장치 상태 관리 구조체 
 struct oled_dev {
     struct i2c_client *client; // I2C 통신용 클라이언트
-    u8 x;
+    u8 x;             // 칩의 실제 주소 포인터 (데이터를 쓴 만큼 앞으로 감)
     u8 page;
+    bool pos_pending; // flush_mode 2: 아직 안 보낸 좌표
+    u8 contrast;      // 깨어날 때 다시 보낼 대비 값 (0x81)
+    u32 resume_count;
+    u64 resume_last_ns, resume_max_ns;
 };
 
 static struct oled_dev g_oled;
 
+// debugfs 통계 (/sys/kernel/debug/oled_ssd1306), stats에 1을 써야 켜짐
+static DEFINE_STATIC_KEY_FALSE(oled_stats);
+static atomic_t n_xfers, n_errors;
+static u64 n_bytes;
+static struct safe_hist xfer_hist;    // I2C 전송 1번
+static struct safe_hist write_hist;   // write() 1번 (문자열 전체)
+static struct dentry *oled_debugfs;
+
+// 모든 I2C 전송은 여기를 거침 (트레이스 + 통계, 둘 다 꺼져 있으면 전송만)
+static int oled_i2c_send(const u8 *buf, int len)
+{
+    ktime_t t0;
+    u64 ns;
+    int ret;
+
+    if (!safe_stats_on(&oled_stats) && !trace_oled_xfer_enabled())
+        return i2c_master_send(g_oled.client, buf, len);
+
+    t0 = ktime_get();
+    ret = i2c_master_send(g_oled.client, buf, len);
+    ns = ktime_to_ns(ktime_sub(ktime_get(), t0));
+
+    trace_oled_xfer(buf[0], len, ret, ns);
+    if (!safe_stats_on(&oled_stats))
+        return ret;
+    atomic_inc(&n_xfers);
+    n_bytes += len;
+    if (ret < 0) atomic_inc(&n_errors);
+    safe_hist_add(&xfer_hist, ns);
+    return ret;
+}
+
 // SSD1306 명령 전송 함수 
 static int oled_send_cmd(u8 cmd)
 {
     u8 buf[2] = {0x00, cmd}; // 제어 바이트(0x00) + 명령어
-    return i2c_master_send(g_oled.client, buf, 2);
+    return oled_i2c_send(buf, 2);
+}
+
+// 좌표 명령을 전송 1번으로 (Co=0 명령 스트림)
+static void oled_send_pos(void)
+{
+    u8 buf[4] = {
+        0x00,
+        0xB0 | g_oled.page,
+        0x00 | (g_oled.x & 0x0F),
+        0x10 | (g_oled.x >> 4),
+    };
+
+    oled_i2c_send(buf, sizeof(buf));
+    g_oled.pos_pending = false;
 }
 
 // 출력 좌표 설정 함수 
@@ -68,9 +140,39 @@ static void oled_set_pos(u8 x, u8 page)
     g_oled.x = x;
     g_oled.page = page;
 
-    oled_send_cmd(0xB0 | page);       // Page 주소 설정
-    oled_send_cmd(0x00 | (x & 0x0F)); // Column 주소 Lower 4bit
-    oled_send_cmd(0x10 | (x >> 4));   // Column 주소 Upper 4bit
+    if (flush_mode == 2) {
+        g_oled.pos_pending = true;
+    } else if (flush_mode == 1) {
+        oled_send_pos();
+    } else {
+        oled_send_cmd(0xB0 | page);       // Page 주소 설정
+        oled_send_cmd(0x00 | (x & 0x0F)); // Column 주소 Lower 4bit
+        oled_send_cmd(0x10 | (x >> 4));   // Column 주소 Upper 4bit
+    }
+}
+
+// 수평 주소 모드: 데이터 1바이트마다 열이 하나 늘고, 127 다음은 다음 페이지 0열
+static void oled_advance(size_t bytes)
+{
+    unsigned int pos = (g_oled.page * 128 + g_oled.x + bytes) % (8 * 128);
+
+    g_oled.page = pos / 128;
+    g_oled.x = pos % 128;
+}
+
+// 데이터 전송 시작 부분: 밀린 좌표가 있으면 Co=1 명령 3개를 앞에 붙이고 0x40(Data)
+static int oled_data_hdr(u8 *buf)
+{
+    int n = 0;
+
+    if (g_oled.pos_pending) {
+        buf[n++] = 0x80; buf[n++] = 0xB0 | g_oled.page;
+        buf[n++] = 0x80; buf[n++] = 0x00 | (g_oled.x & 0x0F);
+        buf[n++] = 0x80; buf[n++] = 0x10 | (g_oled.x >> 4);
+        g_oled.pos_pending = false;
+    }
+    buf[n++] = 0x40;
+    return n;
 }
 
 // 화면 전체 지우기 
@@ -84,8 +186,10 @@ static void oled_clear(void)
 
     for (p = 0; p < 8; p++) {
         oled_set_pos(0, p);
+        if (g_oled.pos_pending) oled_send_pos();
         // 한 페이지(128바이트)를 한 번에 전송
-        i2c_master_send(g_oled.client, buf, 129);
+        oled_i2c_send(buf, 129);
+        oled_advance(128);
     }
     oled_set_pos(0, 0);
 }
@@ -93,49 +197,58 @@ static void oled_clear(void)
 // 문자열 비트맵 출력 함수 
 static void oled_puts(const char *s, size_t n)
 {
-    u8 buf[140]; // 넉넉한 버퍼 크기
-    int i, j, buf_idx = 1;
-    buf[0] = 0x40; // Data 모드
-
-    for (i = 0; i < n; i++) {
-        char c = s[i];
-        if (c == '\0') break;
-        
-        // 폰트 데이터 매핑
-        const unsigned char *g = font5x7[(int)c];
+    u8 buf[146]; // 넉넉한 버퍼 크기 (좌표 명령 6바이트 포함)
+    size_t chars, len;
+    int hdr;
+
+    n = strnlen(s, n);
+    while (n) {
+        hdr = oled_data_hdr(buf); // Data 모드 (+ 밀린 좌표)
+
+        // 버퍼에 들어가는 만큼씩 글자 비트맵으로 풀어 전송 1번
+        chars = min_t(size_t, n, (sizeof(buf) - hdr) / SAFE_GLYPH_W);
+        len = safe_glyph_pack(font5x7, s, chars, buf + hdr);
+        oled_i2c_send(buf, hdr + len);
+        oled_advance(len);
+        s += chars;
+        n -= chars;
+    }
+}
 
-        // 폰트 비트맵 복사
-        for (j = 0; j < 5; j++) {
-            buf[buf_idx++] = g[j];
-        }
-        buf[buf_idx++] = 0x00; // 글자 사이 공백(1픽셀)
+// 런타임 PM: I2C 전송 전후로 깨우고, 다 쓰면 autosuspend 타이머를 다시 걺
+static int oled_pm_get(void)
+{
+    return pm_runtime_resume_and_get(&g_oled.client->dev);
+}
 
-        // 버퍼 가득 참 방지 및 중간 전송
-        if (buf_idx + 6 > sizeof(buf)) {
-            i2c_master_send(g_oled.client, buf, buf_idx);
-            buf_idx = 1;
-        }
-    }
-    if (buf_idx > 1) {
-        i2c_master_send(g_oled.client, buf, buf_idx);
-    }
+static void oled_pm_put(void)
+{
+    pm_runtime_mark_last_busy(&g_oled.client->dev);
+    pm_runtime_put_autosuspend(&g_oled.client->dev);
 }
 
 // IOCTL 인터페이스 
 static long oled_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 {
     oled_pos_t pos;
+    int ret;
 
     switch (cmd) {
     case OLED_CLEAR:
+        ret = oled_pm_get();
+        if (ret) return ret;
         oled_clear();
+        oled_pm_put();
         break;
 
     case OLED_SETPOS:
         if (copy_from_user(&pos, (void __user *)arg, sizeof(pos))) {
             return -EFAULT;
         }
+        ret = oled_pm_get();
+        if (ret) return ret;
         oled_set_pos(pos.x, pos.page);
+        oled_pm_put();
         break;
 
     default:
@@ -149,6 +262,8 @@ static ssize_t oled_write(struct file *file, const char __user *ubuf, size_t len
 {
     char kbuf[128];
     size_t n = len;
+    ktime_t t0;
+    int ret;
 
     if (n == 0) return 0;
     if (n > sizeof(kbuf)) n = sizeof(kbuf) - 1;
@@ -156,7 +271,13 @@ static ssize_t oled_write(struct file *file, const char __user *ubuf, size_t len
     if (copy_from_user(kbuf, ubuf, n)) return -EFAULT;
     
     kbuf[n] = '\0';
+    ret = oled_pm_get();
+    if (ret) return ret;
+    t0 = safe_stats_ktime(&oled_stats);
     oled_puts(kbuf, n);
+    if (safe_stats_on(&oled_stats) && t0)
+        safe_hist_add(&write_hist, ktime_to_ns(ktime_sub(ktime_get(), t0)));
+    oled_pm_put();
 
     return len;
 }
@@ -186,14 +307,75 @@ static int oled_hw_init(void)
     int i;
     for (i = 0; i < ARRAY_SIZE(init_seq); i++)
         oled_send_cmd(init_seq[i]);
+    g_oled.contrast = 0xFF;
     oled_clear();
     return 0;
 }
 
+// 화면 끄기 -> 차지 펌프 끄기 (GDDRAM 내용과 주소 포인터는 그대로 남음)
+static int oled_runtime_suspend(struct device *dev)
+{
+    oled_send_cmd(0xAE);
+    oled_send_cmd(0x8D);
+    oled_send_cmd(0x10);
+    return 0;
+}
+
+// 차지 펌프 켜기 -> 대비 복원 -> 화면 켜기 -> 좌표 복원 (마지막으로 쓴 바이트 다음 위치)
+static int oled_runtime_resume(struct device *dev)
+{
+    ktime_t start = ktime_get();
+    u64 ns;
+
+    oled_send_cmd(0x8D);
+    oled_send_cmd(0x14);
+    oled_send_cmd(0x81);
+    oled_send_cmd(g_oled.contrast);
+    oled_send_cmd(0xAF);
+    if (flush_mode == 2) g_oled.pos_pending = true;
+    else oled_send_pos();
+
+    ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+    g_oled.resume_count++;
+    g_oled.resume_last_ns = ns;
+    g_oled.resume_max_ns = max(g_oled.resume_max_ns, ns);
+    return 0;
+}
+
+static const struct dev_pm_ops oled_pm_ops = {
+    SET_RUNTIME_PM_OPS(oled_runtime_suspend, oled_runtime_resume, NULL)
+};
+
+// 깨어나는 데 걸린 시간 (I2C 명령 전송 포함)
+static ssize_t resume_stats_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    return sysfs_emit(buf, "count=%u last_us=%llu max_us=%llu\n", g_oled.resume_count,
+                      div_u64(g_oled.resume_last_ns, NSEC_PER_USEC),
+                      div_u64(g_oled.resume_max_ns, NSEC_PER_USEC));
+}
+static DEVICE_ATTR_RO(resume_stats);
+
 static int oled_probe(struct i2c_client *client, const struct i2c_device_id *id)
 {
     g_oled.client = client;
     oled_hw_init();
+
+    pm_runtime_set_active(&client->dev);
+    pm_runtime_set_autosuspend_delay(&client->dev, autosuspend_ms);
+    pm_runtime_use_autosuspend(&client->dev);
+    pm_runtime_enable(&client->dev);
+    pm_runtime_mark_last_busy(&client->dev);
+    pm_request_autosuspend(&client->dev);
+    device_create_file(&client->dev, &dev_attr_resume_stats);
+
+    oled_debugfs = debugfs_create_dir("oled_ssd1306", NULL);
+    debugfs_create_atomic_t("xfers", 0444, oled_debugfs, &n_xfers);
+    debugfs_create_atomic_t("errors", 0444, oled_debugfs, &n_errors);
+    debugfs_create_u64("bytes", 0444, oled_debugfs, &n_bytes);
+    safe_hist_debugfs("xfer_hist", oled_debugfs, &xfer_hist);
+    safe_hist_debugfs("write_hist", oled_debugfs, &write_hist);
+    safe_stats_debugfs(oled_debugfs, &oled_stats);
+
     misc_register(&oled_misc);
     dev_info(&client->dev, "OLED Registered: /dev/oled\n");
     return 0;
@@ -202,6 +384,11 @@ static int oled_probe(struct i2c_client *client, const struct i2c_device_id *id)
 static void oled_remove(struct i2c_client *client)
 {
     misc_deregister(&oled_misc);
+    debugfs_remove_recursive(oled_debugfs);
+    device_remove_file(&client->dev, &dev_attr_resume_stats);
+    pm_runtime_disable(&client->dev);
+    pm_runtime_dont_use_autosuspend(&client->dev);
+    pm_runtime_set_suspended(&client->dev);
 }
 
 // 매칭용 데이터 테이블 
@@ -221,6 +408,7 @@ static struct i2c_driver oled_driver = {
     .driver = {
         .name = "oled_ssd1306_char",
         .of_match_table = oled_of_match,
+        .pm = &oled_pm_ops,
     },
     .probe    = oled_probe,
     .remove   = oled_remove,
@@ -0,0 +1,34 @@
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM oled_ssd1306
+
+#if !defined(OLED_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define OLED_TRACE_H
+
+#include <linux/tracepoint.h>
+
+// I2C 전송 한 번 (ctrl: 첫 제어 바이트 0x00 = 명령, 0x40 = 데이터, 0x80 = 좌표+데이터)
+TRACE_EVENT(oled_xfer,
+    TP_PROTO(u8 ctrl, int bytes, int ret, u64 dur_ns),
+    TP_ARGS(ctrl, bytes, ret, dur_ns),
+    TP_STRUCT__entry(
+        __field(u8, ctrl)
+        __field(int, bytes)
+        __field(int, ret)
+        __field(u64, dur_ns)
+    ),
+    TP_fast_assign(
+        __entry->ctrl = ctrl;
+        __entry->bytes = bytes;
+        __entry->ret = ret;
+        __entry->dur_ns = dur_ns;
+    ),
+    TP_printk("ctrl=0x%02x bytes=%d ret=%d dur_ns=%llu",
+              __entry->ctrl, __entry->bytes, __entry->ret, __entry->dur_ns)
+);
+
+#endif
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#define TRACE_INCLUDE_FILE oled_trace
+#include <trace/define_trace.h>
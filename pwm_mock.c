@@ -0,0 +1,162 @@
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/platform_device.h>
+#include <linux/pwm.h>
+#include <linux/ktime.h>
+#include <linux/spinlock.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+
+// 하드웨어 없이 safe_buzzer를 돌리기 위한 가짜 PWM 칩.
+// apply가 불릴 때마다 ktime 타임스탬프와 상태를 기록하고 debugfs로 보여준다.
+//   /sys/kernel/debug/pwm_mock/log   : "ts_ns enabled period_ns duty_ns" 한 줄씩
+//   /sys/kernel/debug/pwm_mock/clear : 아무 값이나 쓰면 기록 초기화
+//   /sys/kernel/debug/pwm_mock/lost  : 기록이 가득 차 버린 apply 수 (0이 아니면 결과를 믿지 말 것)
+
+// buzzer_bench -n 2000 -m seq 한 번에 apply가 약 18000번 (음 4개 x 켜기/끄기 + 주파수 변경)
+static unsigned int log_len = 32768;
+module_param(log_len, uint, 0444);
+MODULE_PARM_DESC(log_len, "number of apply events kept until cleared (default 32768)");
+
+struct mock_evt {
+    u64 ts_ns;
+    u64 period;
+    u64 duty;
+    bool enabled;
+};
+
+static struct mock_evt *mock_log;
+static unsigned int mock_len;
+static unsigned int mock_lost;   // 가득 차서 버린 기록 수
+static DEFINE_SPINLOCK(mock_lock);
+
+static struct platform_device *mock_pdev;
+static struct pwm_chip mock_chip;
+static struct dentry *mock_debugfs;
+
+// 부저의 PWM worker(프로세스 문맥)에서 불림. 기록은 debugfs 읽기와 겹치므로 spinlock
+static int mock_apply(struct pwm_chip *chip, struct pwm_device *pwm,
+                      const struct pwm_state *state)
+{
+    u64 now = ktime_get_ns();
+    unsigned long flags;
+
+    spin_lock_irqsave(&mock_lock, flags);
+    if (mock_len < log_len) {
+        mock_log[mock_len].ts_ns = now;
+        mock_log[mock_len].period = state->period;
+        mock_log[mock_len].duty = state->duty_cycle;
+        mock_log[mock_len].enabled = state->enabled;
+        mock_len++;
+    } else {
+        mock_lost++;
+    }
+    spin_unlock_irqrestore(&mock_lock, flags);
+    return 0;
+}
+
+static const struct pwm_ops mock_ops = {
+    .apply = mock_apply,
+    .owner = THIS_MODULE,
+};
+
+// ---- debugfs ----
+static void *mock_seq_start(struct seq_file *m, loff_t *pos)
+{
+    return *pos < READ_ONCE(mock_len) ? &mock_log[*pos] : NULL;
+}
+
+static void *mock_seq_next(struct seq_file *m, void *v, loff_t *pos)
+{
+    (*pos)++;
+    return mock_seq_start(m, pos);
+}
+
+static void mock_seq_stop(struct seq_file *m, void *v)
+{
+}
+
+static int mock_seq_show(struct seq_file *m, void *v)
+{
+    const struct mock_evt *e = v;
+
+    seq_printf(m, "%llu %d %llu %llu\n", e->ts_ns, e->enabled, e->period, e->duty);
+    return 0;
+}
+
+static const struct seq_operations mock_seq_ops = {
+    .start = mock_seq_start,
+    .next  = mock_seq_next,
+    .stop  = mock_seq_stop,
+    .show  = mock_seq_show,
+};
+DEFINE_SEQ_ATTRIBUTE(mock_seq);
+
+static ssize_t mock_clear_write(struct file *f, const char __user *u, size_t c, loff_t *o)
+{
+    unsigned long flags;
+
+    spin_lock_irqsave(&mock_lock, flags);
+    mock_len = 0;
+    mock_lost = 0;
+    spin_unlock_irqrestore(&mock_lock, flags);
+    return c;
+}
+
+static const struct file_operations mock_clear_fops = {
+    .owner = THIS_MODULE,
+    .write = mock_clear_write,
+};
+
+static int __init pwm_mock_init(void)
+{
+    int ret;
+
+    if (!log_len)
+        return -EINVAL;
+    mock_log = kvcalloc(log_len, sizeof(*mock_log), GFP_KERNEL);
+    if (!mock_log)
+        return -ENOMEM;
+
+    mock_pdev = platform_device_register_simple("pwm-mock", -1, NULL, 0);
+    if (IS_ERR(mock_pdev)) {
+        kvfree(mock_log);
+        return PTR_ERR(mock_pdev);
+    }
+
+    mock_chip.dev = &mock_pdev->dev;
+    mock_chip.ops = &mock_ops;
+    mock_chip.npwm = 1;
+    ret = pwmchip_add(&mock_chip);
+    if (ret) {
+        platform_device_unregister(mock_pdev);
+        kvfree(mock_log);
+        return ret;
+    }
+
+    mock_debugfs = debugfs_create_dir("pwm_mock", NULL);
+    debugfs_create_file("log", 0444, mock_debugfs, NULL, &mock_seq_fops);
+    debugfs_create_file("clear", 0200, mock_debugfs, NULL, &mock_clear_fops);
+    debugfs_create_u32("lost", 0444, mock_debugfs, &mock_lost);
+
+    pr_info("pwm_mock: registered (log %u events), load safe_buzzer with pwm_index=%d\n",
+            log_len, mock_chip.base);
+    return 0;
+}
+
+static void __exit pwm_mock_exit(void)
+{
+    debugfs_remove_recursive(mock_debugfs);
+    pwmchip_remove(&mock_chip);
+    platform_device_unregister(mock_pdev);
+    kvfree(mock_log);
+}
+
+module_init(pwm_mock_init);
+module_exit(pwm_mock_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_AUTHOR("kkk");
+MODULE_DESCRIPTION("Mock PWM chip that timestamps every apply (buzzer timing tests)");
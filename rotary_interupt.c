@@ -9,21 +9,68 @@
 #include <linux/wait.h>
 #include <linux/sched.h>
 #include <linux/jiffies.h>
+#include <linux/notifier.h>
+#include <linux/poll.h>
+#include <linux/hrtimer.h>
+#include <linux/mm.h>
+#include <linux/spinlock.h>
+#include <linux/pm_runtime.h>
+#include <linux/debugfs.h>
+#include <linux/kthread.h>
+#include <uapi/linux/sched/types.h>
+
+#include "safe_rotary.h"
+#include "safe_status.h"
+#include "safe_hist.h"
+#include "safe_logic.h"
+
+#define CREATE_TRACE_POINTS
+#include "rotary_trace.h"
 
 #define DRIVER_NAME "safe_rotary"
 #define CLASS_NAME "safe_rotary_class"
-#define S1_GPIO 20
-#define S2_GPIO 21
-#define SW_GPIO 16
 #define ROT_DEBOUNCE_MS 50
 
 MODULE_LICENSE("GPL");
 MODULE_AUTHOR("kkk");
 MODULE_DESCRIPTION("rotary driver");
 
+// GPIO BCM 번호 (gpio-sim 등으로 벤치마크할 때 바꿔서 로드)
+static int s1_gpio = 20;
+static int s2_gpio = 21;
+static int sw_gpio = 16;
+module_param(s1_gpio, int, 0444);
+module_param(s2_gpio, int, 0444);
+module_param(sw_gpio, int, 0444);
+
+// 회전 입력 방식: 0 = S1 Falling 인터럽트, 1 = hrtimer로 주기 샘플링
+static bool poll_mode = false;
+module_param(poll_mode, bool, 0444);
+MODULE_PARM_DESC(poll_mode, "sample the encoder with an hrtimer instead of the S1 edge IRQ");
+
+static int poll_us = 1000;
+module_param(poll_us, int, 0444);
+MODULE_PARM_DESC(poll_us, "sampling period in us for poll_mode");
+
+// poll_mode에서 이 시간 동안 입력이 없으면 폴링을 멈추고 S1 Falling 인터럽트로 깨어남
+static int autosuspend_ms = 2000;
+module_param(autosuspend_ms, int, 0444);
+MODULE_PARM_DESC(autosuspend_ms, "poll_mode idle time in ms before switching to a wake-on-edge IRQ");
+
+// 실시간 입력 (IRQ 방식 전용): hardirq는 에지 시각/S2만 기록하고,
+// SCHED_FIFO rt_prio 커널 스레드가 칸 처리. rt_cpu >= 0 이면 스레드와 S1 IRQ를 그 CPU에 고정
+static int rt_prio = 0;
+module_param(rt_prio, int, 0444);
+MODULE_PARM_DESC(rt_prio, "SCHED_FIFO priority (1-99) of the rotary kthread, 0 = handle edges in hardirq");
+
+static int rt_cpu = -1;
+module_param(rt_cpu, int, 0444);
+MODULE_PARM_DESC(rt_cpu, "CPU for the rotary kthread and S1 IRQ in rt mode (-1 = no pinning)");
+
 static dev_t device_number;
 static struct cdev rotary_cdev;
 static struct class *rotary_class;
+static struct device *rotary_device;
 
 static int irq_s1;
 static int irq_sw;
@@ -37,40 +84,270 @@ static DECLARE_WAIT_QUEUE_HEAD(rotary_wait_queue);
 // 버튼 롱프레스 감지를 위한 커널 타이머
 static struct timer_list btn_timer;
 
-// 1. 로터리 인터럽트 핸들러 (Falling Edge)
-static irqreturn_t rot_handler(int irq, void *dev_id) {
+// mmap 상태 페이지 (seqlock, 인터럽트/타이머 양쪽에서 갱신하므로 스핀락으로 직렬화)
+static struct safe_rotary_status *rot_status;
+static DEFINE_SPINLOCK(rot_status_lock);
+
+// 라인이 잠들 수 있는 칩(gpio-sim, I2C 확장칩 등)에 있으면 hardirq/hrtimer에서 읽을 수 없다.
+// 이 경우 hardirq는 에지 시각만 남기고 레벨은 IRQ 스레드에서 _cansleep으로 읽으며,
+// poll_mode 샘플링도 hrtimer 대신 커널 스레드에서 한다.
+static bool gpio_sleeps;
+
+// poll_mode 샘플링 타이머(또는 스레드)와 직전 S1 레벨
+static struct hrtimer poll_timer;
+static struct task_struct *poll_task;   // gpio_sleeps 일 때만
+static DECLARE_WAIT_QUEUE_HEAD(poll_wq);
+static bool poll_run;
+static int s1_prev = 1;
+
+// 런타임 PM (poll_mode 전용): 쉬는 동안은 S1 인터럽트만 켜 둠
+static atomic_t wake_armed = ATOMIC_INIT(0);
+static ktime_t wake_ts;          // 깨우는 에지가 들어온 시각
+static u32 resume_count;
+static u64 resume_last_ns, resume_max_ns;
+
+// debugfs 통계 (/sys/kernel/debug/safe_rotary), stats에 1을 써야 켜짐
+// 꺼져 있으면 에지 시각도 재지 않음 (ts = 0)
+enum { ROT_SRC_IRQ, ROT_SRC_POLL, ROT_SRC_WAKE };
+static DEFINE_STATIC_KEY_FALSE(rot_stats);
+static atomic_t n_edges, n_accepted, n_rejected, n_buttons;
+static struct safe_hist read_hist;   // 에지(hardirq) -> read()로 가져가기까지
+static struct safe_hist step_hist;   // rt 모드: 에지(hardirq) -> 스레드가 칸 처리 완료
+static ktime_t last_event_ts;
+static struct dentry *rot_debugfs;
+
+// rt 모드 스레드와 hardirq가 넘겨주는 에지 정보
+static struct task_struct *rot_task;
+static DECLARE_WAIT_QUEUE_HEAD(rot_task_wq);
+static atomic_t rt_pending = ATOMIC_INIT(0);
+static ktime_t rt_edge_ts;
+static int rt_s2;                // -1: 스레드에서 읽음 (gpio_sleeps)
+
+// gpio_sleeps: hardirq -> IRQ 스레드로 넘기는 에지 시각 (ONESHOT이라 한 칸이면 충분)
+static ktime_t edge_ts;
+
+// 회전 이벤트 구독자 (부저 근접 피드백 등)
+static ATOMIC_NOTIFIER_HEAD(rotary_notifier);
+
+int safe_rotary_register_notifier(struct notifier_block *nb) {
+    return atomic_notifier_chain_register(&rotary_notifier, nb);
+}
+EXPORT_SYMBOL_GPL(safe_rotary_register_notifier);
+
+int safe_rotary_unregister_notifier(struct notifier_block *nb) {
+    return atomic_notifier_chain_unregister(&rotary_notifier, nb);
+}
+EXPORT_SYMBOL_GPL(safe_rotary_unregister_notifier);
+
+// 상태 페이지 갱신 (btn: 0이면 회전, 1/2면 버튼)
+static void rot_status_update(int btn) {
+    unsigned long flags;
+
+    spin_lock_irqsave(&rot_status_lock, flags);
+    WRITE_ONCE(rot_status->seq, rot_status->seq + 1);
+    smp_wmb();
+    rot_status->value = rotary_value;
+    if (btn) {
+        rot_status->btn = btn;
+        rot_status->btn_count++;
+    }
+    rot_status->events++;
+    rot_status->ts_ns = ktime_get_ns();
+    smp_wmb();
+    WRITE_ONCE(rot_status->seq, rot_status->seq + 1);
+    spin_unlock_irqrestore(&rot_status_lock, flags);
+}
+
+// S1 Falling 한 번 처리 (인터럽트/샘플링/rt 스레드 공용)
+// s2: 에지 순간의 S2 레벨, ts: 에지 시각
+static void rot_step(int src, int s2, ktime_t ts) {
     unsigned long current_time = jiffies;
     unsigned long debounce_jiffies = msecs_to_jiffies(ROT_DEBOUNCE_MS);
+    long step;
+
+    // S1이 Falling일 때 S2의 레벨로 방향 판별
+    step = safe_rot_dir(s2);
+    trace_rotary_edge(src, s2);
+    if (safe_stats_on(&rot_stats))
+        atomic_inc(&n_edges);
 
     // 디바운싱 체크: 마지막 인터럽트로부터 설정된 MS가 지나지 않았으면 무시
-    if (time_before(current_time, last_rot_interrupt + debounce_jiffies)) {
-        return IRQ_HANDLED;
+    if (!safe_rot_accept(current_time, &last_rot_interrupt, debounce_jiffies)) {
+        trace_rotary_detent(step, rotary_value, false);
+        if (safe_stats_on(&rot_stats))
+            atomic_inc(&n_rejected);
+        return;
     }
-    last_rot_interrupt = current_time;
 
-    // S1이 Falling일 때 S2의 레벨을 읽어 방향 판별
-    if (gpio_get_value(S2_GPIO)) {
-        rotary_value++;
-    } else {
-        rotary_value--;
+    rotary_value += step;
+    trace_rotary_detent(step, rotary_value, true);
+    if (safe_stats_on(&rot_stats)) {
+        atomic_inc(&n_accepted);
+        last_event_ts = ts;
     }
+    rot_status_update(0);
+    if (poll_mode) {
+        pm_runtime_mark_last_busy(rotary_device);
+        pm_request_autosuspend(rotary_device);
+    }
+    atomic_notifier_call_chain(&rotary_notifier, SAFE_ROTARY_STEP, (void *)step);
 
     data_ready = 1;
     wake_up_interruptible(&rotary_wait_queue);
+}
+
+// 1. 로터리 인터럽트 핸들러 (Falling Edge)
+static irqreturn_t rot_handler(int irq, void *dev_id) {
+    if (gpio_sleeps) {
+        edge_ts = safe_stats_ktime(&rot_stats);
+        return IRQ_WAKE_THREAD;
+    }
+    rot_step(ROT_SRC_IRQ, gpio_get_value(s2_gpio), safe_stats_ktime(&rot_stats));
+    return IRQ_HANDLED;
+}
+
+static irqreturn_t rot_thread_handler(int irq, void *dev_id) {
+    rot_step(ROT_SRC_IRQ, gpio_get_value_cansleep(s2_gpio), edge_ts);
+    return IRQ_HANDLED;
+}
+
+// 1-3. rt 모드: 에지 순간의 정보만 남기고 스레드를 깨움
+static irqreturn_t rot_rt_handler(int irq, void *dev_id) {
+    rt_edge_ts = safe_stats_ktime(&rot_stats);
+    rt_s2 = gpio_sleeps ? -1 : gpio_get_value(s2_gpio);
+    atomic_set_release(&rt_pending, 1);
+    wake_up(&rot_task_wq);
     return IRQ_HANDLED;
 }
 
+static int rot_thread_fn(void *arg) {
+    ktime_t ts;
+    int s2;
+
+    while (!kthread_should_stop()) {
+        wait_event_interruptible(rot_task_wq, atomic_read(&rt_pending) || kthread_should_stop());
+        if (!atomic_xchg(&rt_pending, 0))
+            continue;
+        // 처리 전에 다음 에지가 들어오면 합쳐짐 (어차피 디바운스 창 안)
+        ts = rt_edge_ts;
+        s2 = rt_s2;
+        if (s2 < 0)
+            s2 = gpio_get_value_cansleep(s2_gpio);
+        rot_step(ROT_SRC_IRQ, s2, ts);
+        if (safe_stats_on(&rot_stats) && ts)
+            safe_hist_add(&step_hist, ktime_to_ns(ktime_sub(ktime_get(), ts)));
+    }
+    return 0;
+}
+
+// rt_prio 스레드 생성 + 우선순위/CPU 고정
+static int rot_rt_start(void) {
+    struct sched_attr attr = {
+        .size = sizeof(attr),
+        .sched_policy = SCHED_FIFO,
+        .sched_priority = clamp(rt_prio, 1, MAX_RT_PRIO - 1),
+    };
+    int ret;
+
+    rot_task = kthread_create(rot_thread_fn, NULL, "safe_rotary_rt");
+    if (IS_ERR(rot_task)) {
+        ret = PTR_ERR(rot_task);
+        rot_task = NULL;
+        return ret;
+    }
+    if (rt_cpu >= 0 && cpu_online(rt_cpu))
+        kthread_bind(rot_task, rt_cpu);
+    ret = sched_setattr_nocheck(rot_task, &attr);
+    if (ret) {
+        kthread_stop(rot_task);
+        rot_task = NULL;
+        return ret;
+    }
+    wake_up_process(rot_task);
+    return 0;
+}
+
+// 1-2. poll_mode에서 쉬는 중 S1 Falling: 이 칸을 처리하고 폴링 재개 요청
+static irqreturn_t rot_wake_handler(int irq, void *dev_id) {
+    if (atomic_xchg(&wake_armed, 0)) {
+        disable_irq_nosync(irq);
+        wake_ts = ktime_get();
+        if (gpio_sleeps)
+            return IRQ_WAKE_THREAD;
+        rot_step(ROT_SRC_WAKE, gpio_get_value(s2_gpio), wake_ts);
+        pm_request_resume(rotary_device);
+    }
+    return IRQ_HANDLED;
+}
+
+static irqreturn_t rot_wake_thread(int irq, void *dev_id) {
+    rot_step(ROT_SRC_WAKE, gpio_get_value_cansleep(s2_gpio), wake_ts);
+    pm_request_resume(rotary_device);
+    return IRQ_HANDLED;
+}
+
+// 1-1. poll_mode: poll_us마다 S1을 읽어 1 -> 0 변화를 Falling으로 처리
+static enum hrtimer_restart poll_timer_func(struct hrtimer *t) {
+    int s1 = gpio_get_value(s1_gpio);
+
+    if (s1_prev && !s1) rot_step(ROT_SRC_POLL, gpio_get_value(s2_gpio), safe_stats_ktime(&rot_stats));
+    s1_prev = s1;
+
+    hrtimer_forward_now(t, us_to_ktime(poll_us));
+    return HRTIMER_RESTART;
+}
+
+// gpio_sleeps: 같은 샘플링을 커널 스레드에서 (usleep_range도 hrtimer 기반)
+static int poll_thread_fn(void *arg) {
+    int s1;
+
+    while (!kthread_should_stop()) {
+        if (!READ_ONCE(poll_run)) {
+            wait_event_interruptible(poll_wq, READ_ONCE(poll_run) || kthread_should_stop());
+            continue;
+        }
+        s1 = gpio_get_value_cansleep(s1_gpio);
+        if (s1_prev && !s1) rot_step(ROT_SRC_POLL, gpio_get_value_cansleep(s2_gpio), safe_stats_ktime(&rot_stats));
+        s1_prev = s1;
+        usleep_range(poll_us, poll_us + poll_us / 8);
+    }
+    return 0;
+}
+
+static void rot_poll_start(void) {
+    s1_prev = gpio_get_value_cansleep(s1_gpio);
+    if (poll_task) {
+        WRITE_ONCE(poll_run, true);
+        wake_up(&poll_wq);
+    } else {
+        hrtimer_start(&poll_timer, us_to_ktime(poll_us), HRTIMER_MODE_REL);
+    }
+}
+
+// 스레드는 다음 샘플 뒤에 멈춤 (그 사이 깨우기 인터럽트와 겹쳐도 디바운스 창 안)
+static void rot_poll_stop(void) {
+    if (poll_task)
+        WRITE_ONCE(poll_run, false);
+    else
+        hrtimer_cancel(&poll_timer);
+}
+
 // 버튼 타이머 콜백 (1초 경과 시 호출)
 static void btn_timer_func(struct timer_list *t) {
     btn_state = 2; // Long Press 발생
+    trace_rotary_button(2);
+    if (safe_stats_on(&rot_stats)) {
+        atomic_inc(&n_buttons);
+        last_event_ts = ktime_get();
+    }
+    rot_status_update(2);
+    atomic_notifier_call_chain(&rotary_notifier, SAFE_ROTARY_BUTTON, (void *)2L);
     data_ready = 1;
     wake_up_interruptible(&rotary_wait_queue);
 }
 
-// 버튼 인터럽트 핸들러 (누름/뗌 양방향 감지)
-static irqreturn_t btn_handler(int irq, void *dev_id) {
-    int btn_val = gpio_get_value(SW_GPIO);
-
+// 버튼 에지 처리 (누름/뗌 양방향 감지)
+static void btn_edge(int btn_val) {
     if (btn_val == 0) { // 누름 (Falling)
         // 1초 뒤에 터지는 타이머 설정
         mod_timer(&btn_timer, jiffies + msecs_to_jiffies(1000));
@@ -79,10 +356,29 @@ static irqreturn_t btn_handler(int irq, void *dev_id) {
         // 타이머가 아직 실행 전이라면 취소하고 Short Press 처리
         if (del_timer(&btn_timer)) {
             btn_state = 1; // Short Press
+            trace_rotary_button(1);
+            if (safe_stats_on(&rot_stats)) {
+                atomic_inc(&n_buttons);
+                last_event_ts = ktime_get();
+            }
+            rot_status_update(1);
+            atomic_notifier_call_chain(&rotary_notifier, SAFE_ROTARY_BUTTON, (void *)1L);
             data_ready = 1;
             wake_up_interruptible(&rotary_wait_queue);
         }
     }
+}
+
+// 버튼 인터럽트 핸들러
+static irqreturn_t btn_handler(int irq, void *dev_id) {
+    if (gpio_sleeps)
+        return IRQ_WAKE_THREAD;
+    btn_edge(gpio_get_value(sw_gpio));
+    return IRQ_HANDLED;
+}
+
+static irqreturn_t btn_thread_handler(int irq, void *dev_id) {
+    btn_edge(gpio_get_value_cansleep(sw_gpio));
     return IRQ_HANDLED;
 }
 
@@ -91,12 +387,18 @@ static ssize_t rotary_read(struct file *file, char __user *user_buff, size_t cou
     char buffer[32];
     int len;
 
+    // O_NONBLOCK: poll/epoll로 깨어난 앱은 기다리지 않고 바로 확인
+    if (file->f_flags & O_NONBLOCK) {
+        if (!data_ready) return -EAGAIN;
+    }
     // 데이터가 준비될 때까지 대기 (Timeout 50ms 설정으로 앱 프리징 방지)
-    if (wait_event_interruptible_timeout(rotary_wait_queue, data_ready != 0, msecs_to_jiffies(50)) <= 0) {
+    else if (wait_event_interruptible_timeout(rotary_wait_queue, data_ready != 0, msecs_to_jiffies(50)) <= 0) {
         return 0;
     }
 
     data_ready = 0;
+    if (safe_stats_on(&rot_stats) && last_event_ts)
+        safe_hist_add(&read_hist, ktime_to_ns(ktime_sub(ktime_get(), last_event_ts)));
 
     // 우선순위: 버튼 상태 확인 후 로터리 값 확인
     if (btn_state == 2) {
@@ -113,76 +415,255 @@ static ssize_t rotary_read(struct file *file, char __user *user_buff, size_t cou
     return len;
 }
 
+static __poll_t rotary_poll(struct file *file, poll_table *wait) {
+    poll_wait(file, &rotary_wait_queue, wait);
+    return data_ready ? (EPOLLIN | EPOLLRDNORM) : 0;
+}
+
+// 상태 페이지를 읽기 전용으로 매핑 (시스템 콜 없이 현재 상태 확인)
+static int rotary_mmap(struct file *file, struct vm_area_struct *vma) {
+    if (vma->vm_pgoff || vma->vm_end - vma->vm_start > PAGE_SIZE) return -EINVAL;
+    if (vma->vm_flags & VM_WRITE) return -EPERM;
+    vma->vm_flags &= ~VM_MAYWRITE;
+
+    return remap_pfn_range(vma, vma->vm_start, virt_to_phys(rot_status) >> PAGE_SHIFT,
+                           PAGE_SIZE, vma->vm_page_prot);
+}
+
+// 런타임 PM 콜백 (poll_mode에서만 활성화)
+static int rotary_runtime_suspend(struct device *dev) {
+    rot_poll_stop();
+    wake_ts = 0;
+    atomic_set(&wake_armed, 1);
+    enable_irq(irq_s1);
+    return 0;
+}
+
+static int rotary_runtime_resume(struct device *dev) {
+    ktime_t start = wake_ts ? wake_ts : ktime_get();
+    u64 ns;
+
+    // 에지가 아닌 다른 이유로 깨어났으면 인터럽트를 직접 끔
+    if (atomic_xchg(&wake_armed, 0))
+        disable_irq(irq_s1);
+
+    rot_poll_start();
+
+    ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+    resume_count++;
+    resume_last_ns = ns;
+    resume_max_ns = max(resume_max_ns, ns);
+
+    pm_runtime_mark_last_busy(dev);
+    pm_request_autosuspend(dev);
+    return 0;
+}
+
+static const struct dev_pm_ops rotary_pm_ops = {
+    SET_RUNTIME_PM_OPS(rotary_runtime_suspend, rotary_runtime_resume, NULL)
+};
+
+// 에지 -> 폴링 재개까지 걸린 시간
+static ssize_t resume_stats_show(struct device *dev, struct device_attribute *attr, char *buf) {
+    return sysfs_emit(buf, "count=%u last_us=%llu max_us=%llu\n", resume_count,
+                      div_u64(resume_last_ns, NSEC_PER_USEC), div_u64(resume_max_ns, NSEC_PER_USEC));
+}
+static DEVICE_ATTR_RO(resume_stats);
+
 static struct file_operations fops = {
     .owner = THIS_MODULE,
-    .read  = rotary_read
+    .read  = rotary_read,
+    .poll  = rotary_poll,
+    .mmap  = rotary_mmap
 };
 
 // 초기화 함수
 static int __init rotary_driver_init(void) {
+    unsigned long oneshot;
     int ret;
 
+    rot_status = (void *)get_zeroed_page(GFP_KERNEL);
+    if (!rot_status) return -ENOMEM;
+
     // 장치 번호 할당
-    if ((ret = alloc_chrdev_region(&device_number, 0, 1, DRIVER_NAME)) < 0) return ret;
+    ret = alloc_chrdev_region(&device_number, 0, 1, DRIVER_NAME);
+    if (ret < 0)
+        goto err_page;
 
     // 문자 장치 초기화 및 등록
     cdev_init(&rotary_cdev, &fops);
-    if ((ret = cdev_add(&rotary_cdev, device_number, 1)) < 0) {
-        unregister_chrdev_region(device_number, 1);
-        return ret;
-    }
+    ret = cdev_add(&rotary_cdev, device_number, 1);
+    if (ret < 0)
+        goto err_region;
 
     // 클래스 및 장치 파일 생성 (/dev/safe_rotary)
     rotary_class = class_create(THIS_MODULE, CLASS_NAME);
     if (IS_ERR(rotary_class)) {
-        cdev_del(&rotary_cdev);
-        unregister_chrdev_region(device_number, 1);
-        return PTR_ERR(rotary_class);
+        ret = PTR_ERR(rotary_class);
+        goto err_cdev;
+    }
+    rotary_class->pm = &rotary_pm_ops;
+    rotary_device = device_create(rotary_class, NULL, device_number, NULL, DRIVER_NAME);
+    if (IS_ERR(rotary_device)) {
+        ret = PTR_ERR(rotary_device);
+        goto err_class;
     }
-    device_create(rotary_class, NULL, device_number, NULL, DRIVER_NAME);
 
     // GPIO 요청 및 설정
-    gpio_request(S1_GPIO, "s1"); gpio_direction_input(S1_GPIO);
-    gpio_request(S2_GPIO, "s2"); gpio_direction_input(S2_GPIO);
-    gpio_request(SW_GPIO, "sw"); gpio_direction_input(SW_GPIO);
+    ret = gpio_request(s1_gpio, "s1");
+    if (ret)
+        goto err_device;
+    ret = gpio_request(s2_gpio, "s2");
+    if (ret)
+        goto err_s1;
+    ret = gpio_request(sw_gpio, "sw");
+    if (ret)
+        goto err_s2;
+    gpio_direction_input(s1_gpio);
+    gpio_direction_input(s2_gpio);
+    gpio_direction_input(sw_gpio);
+
+    gpio_sleeps = gpio_cansleep(s1_gpio) || gpio_cansleep(s2_gpio) || gpio_cansleep(sw_gpio);
+    oneshot = gpio_sleeps ? IRQF_ONESHOT : 0;
+    if (gpio_sleeps)
+        pr_info("safe_rotary: GPIO lines can sleep, reading levels from IRQ threads\n");
 
     // 버튼 롱프레스 타이머 설정
     timer_setup(&btn_timer, btn_timer_func, 0);
 
     // 인터럽트 요청
-    irq_s1 = gpio_to_irq(S1_GPIO);
-    irq_sw = gpio_to_irq(SW_GPIO);
+    irq_s1 = gpio_to_irq(s1_gpio);
+    irq_sw = gpio_to_irq(sw_gpio);
+
+    // S1: Falling Edge 감지 (회전 감지용), poll_mode면 hrtimer 샘플링
+    if (poll_mode) {
+        if (poll_us < 100) poll_us = 100;
+        hrtimer_init(&poll_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+        poll_timer.function = poll_timer_func;
+        if (gpio_sleeps) {
+            poll_task = kthread_run(poll_thread_fn, NULL, "safe_rotary_poll");
+            if (IS_ERR(poll_task)) {
+                ret = PTR_ERR(poll_task);
+                poll_task = NULL;
+                goto err_gpio;
+            }
+        }
 
-    // S1: Falling Edge 감지 (회전 감지용)
-    ret = request_irq(irq_s1, rot_handler, IRQF_TRIGGER_FALLING, "rot_irq_s1", NULL);
-    if (ret) {
-        return ret;
+        // 깨우기용 S1 인터럽트는 쉬는 동안만 켬
+        ret = request_threaded_irq(irq_s1, rot_wake_handler, gpio_sleeps ? rot_wake_thread : NULL,
+                                   IRQF_TRIGGER_FALLING | IRQF_NO_AUTOEN | oneshot, "rot_wake_s1", NULL);
+        if (ret)
+            goto err_tasks;
+        rot_poll_start();
+
+        pm_runtime_set_active(rotary_device);
+        pm_runtime_set_autosuspend_delay(rotary_device, autosuspend_ms);
+        pm_runtime_use_autosuspend(rotary_device);
+        pm_runtime_enable(rotary_device);
+        pm_runtime_mark_last_busy(rotary_device);
+        pm_request_autosuspend(rotary_device);
+        device_create_file(rotary_device, &dev_attr_resume_stats);
+    } else if (rt_prio > 0) {
+        ret = rot_rt_start();
+        if (ret)
+            goto err_gpio;
+        ret = request_irq(irq_s1, rot_rt_handler, IRQF_TRIGGER_FALLING, "rot_irq_s1", NULL);
+        if (ret)
+            goto err_tasks;
+        if (rt_cpu >= 0 && cpu_online(rt_cpu))
+            irq_set_affinity_hint(irq_s1, cpumask_of(rt_cpu));
+    } else {
+        ret = request_threaded_irq(irq_s1, rot_handler, gpio_sleeps ? rot_thread_handler : NULL,
+                                   IRQF_TRIGGER_FALLING | oneshot, "rot_irq_s1", NULL);
+        if (ret)
+            goto err_gpio;
     }
 
     // SW: 누름(Falling)과 뗌(Rising) 모두 감지 (타이머 제어용)
-    ret = request_irq(irq_sw, btn_handler, IRQF_TRIGGER_FALLING | IRQF_TRIGGER_RISING, "btn_irq_sw", NULL);
-    if (ret) {
-        free_irq(irq_s1, NULL); 
-        return ret;
-    }
+    ret = request_threaded_irq(irq_sw, btn_handler, gpio_sleeps ? btn_thread_handler : NULL,
+                               IRQF_TRIGGER_FALLING | IRQF_TRIGGER_RISING | oneshot, "btn_irq_sw", NULL);
+    if (ret)
+        goto err_irq_s1;
+
+    rot_debugfs = debugfs_create_dir(DRIVER_NAME, NULL);
+    debugfs_create_atomic_t("edges", 0444, rot_debugfs, &n_edges);
+    debugfs_create_atomic_t("accepted", 0444, rot_debugfs, &n_accepted);
+    debugfs_create_atomic_t("rejected", 0444, rot_debugfs, &n_rejected);
+    debugfs_create_atomic_t("buttons", 0444, rot_debugfs, &n_buttons);
+    safe_hist_debugfs("event_to_read_hist", rot_debugfs, &read_hist);
+    safe_stats_debugfs(rot_debugfs, &rot_stats);
+    if (rot_task)
+        safe_hist_debugfs("edge_to_step_hist", rot_debugfs, &step_hist);
 
     printk(KERN_INFO "Safe Rotary Driver initialized successfully\n");
     return 0;
+
+    // 실패 시 get_zeroed_page 이후 얻은 것을 역순으로 해제 (다음 insmod가 막히지 않게)
+err_irq_s1:
+    if (poll_mode) {
+        device_remove_file(rotary_device, &dev_attr_resume_stats);
+        pm_runtime_disable(rotary_device);
+        pm_runtime_dont_use_autosuspend(rotary_device);
+        rot_poll_stop();
+    }
+    if (rot_task)
+        irq_set_affinity_hint(irq_s1, NULL);
+    free_irq(irq_s1, NULL);
+err_tasks:
+    if (poll_task) {
+        kthread_stop(poll_task);
+        poll_task = NULL;
+    }
+    if (rot_task) {
+        kthread_stop(rot_task);
+        rot_task = NULL;
+    }
+err_gpio:
+    gpio_free(sw_gpio);
+err_s2:
+    gpio_free(s2_gpio);
+err_s1:
+    gpio_free(s1_gpio);
+err_device:
+    device_destroy(rotary_class, device_number);
+err_class:
+    class_destroy(rotary_class);
+err_cdev:
+    cdev_del(&rotary_cdev);
+err_region:
+    unregister_chrdev_region(device_number, 1);
+err_page:
+    free_page((unsigned long)rot_status);
+    return ret;
 }
 
 static void __exit rotary_driver_exit(void) {
+    debugfs_remove_recursive(rot_debugfs);
     del_timer_sync(&btn_timer);
+    if (poll_mode) {
+        device_remove_file(rotary_device, &dev_attr_resume_stats);
+        pm_runtime_disable(rotary_device);
+        pm_runtime_dont_use_autosuspend(rotary_device);
+        rot_poll_stop();
+        if (poll_task)
+            kthread_stop(poll_task);
+    }
+    if (rot_task)
+        irq_set_affinity_hint(irq_s1, NULL);
     free_irq(irq_s1, NULL);
     free_irq(irq_sw, NULL);
+    if (rot_task)
+        kthread_stop(rot_task);
     
-    gpio_free(S1_GPIO);
-    gpio_free(S2_GPIO);
-    gpio_free(SW_GPIO);
+    gpio_free(s1_gpio);
+    gpio_free(s2_gpio);
+    gpio_free(sw_gpio);
 
     device_destroy(rotary_class, device_number);
     class_destroy(rotary_class);
     cdev_del(&rotary_cdev);
     unregister_chrdev_region(device_number, 1);
+    free_page((unsigned long)rot_status);
     
     printk(KERN_INFO "Safe Rotary Driver exited\n");
 }
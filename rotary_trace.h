@@ -0,0 +1,61 @@
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM safe_rotary
+
+#if !defined(ROTARY_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define ROTARY_TRACE_H
+
+#include <linux/tracepoint.h>
+
+// S1 Falling 에지 (src: 0 = IRQ, 1 = 폴링, 2 = 런타임 PM 깨우기)
+TRACE_EVENT(rotary_edge,
+    TP_PROTO(int src, int s2),
+    TP_ARGS(src, s2),
+    TP_STRUCT__entry(
+        __field(int, src)
+        __field(int, s2)
+    ),
+    TP_fast_assign(
+        __entry->src = src;
+        __entry->s2 = s2;
+    ),
+    TP_printk("src=%s s2=%d",
+              __print_symbolic(__entry->src, { 0, "irq" }, { 1, "poll" }, { 2, "wake" }),
+              __entry->s2)
+);
+
+// 에지 하나가 한 칸으로 인정됐는지 (디바운스로 버려지면 accepted=0)
+TRACE_EVENT(rotary_detent,
+    TP_PROTO(long step, long value, bool accepted),
+    TP_ARGS(step, value, accepted),
+    TP_STRUCT__entry(
+        __field(long, step)
+        __field(long, value)
+        __field(bool, accepted)
+    ),
+    TP_fast_assign(
+        __entry->step = step;
+        __entry->value = value;
+        __entry->accepted = accepted;
+    ),
+    TP_printk("step=%ld value=%ld accepted=%d", __entry->step, __entry->value, __entry->accepted)
+);
+
+// 버튼 이벤트 (1: Short, 2: Long)
+TRACE_EVENT(rotary_button,
+    TP_PROTO(int type),
+    TP_ARGS(type),
+    TP_STRUCT__entry(
+        __field(int, type)
+    ),
+    TP_fast_assign(
+        __entry->type = type;
+    ),
+    TP_printk("%s", __entry->type == 2 ? "long" : "short")
+);
+
+#endif
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#define TRACE_INCLUDE_FILE rotary_trace
+#include <trace/define_trace.h>
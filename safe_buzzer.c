@@ -1,10 +1,29 @@
 #include <linux/module.h>
 #include <linux/kernel.h>
 #include <linux/init.h>
-#include <linux/pwm.h> 
+#include <linux/pwm.h>
+#include <linux/hrtimer.h>
 #include <linux/timer.h>
+#include <linux/jiffies.h>
+#include <linux/ktime.h>
 #include <linux/cdev.h>
 #include <linux/uaccess.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/wait.h>
+#include <linux/poll.h>
+#include <linux/notifier.h>
+#include <linux/pm_runtime.h>
+#include <linux/debugfs.h>
+#include <linux/kthread.h>
+#include <linux/mutex.h>
+
+#include "safe_rotary.h"
+#include "safe_events.h"
+#include "safe_hist.h"
+
+#define CREATE_TRACE_POINTS
+#include "buzzer_trace.h"
 
 #define DRIVER_NAME "safe_buzzer"
 
@@ -13,72 +32,786 @@ MODULE_LICENSE("GPL");
 static dev_t dev_num;
 static struct cdev cdev;
 static struct class *cls;
+static struct device *buz_dev;
 
 // 하드웨어 PWM 구조체
 static struct pwm_device *pwm0 = NULL;
-static struct timer_list stop_timer; // 소리를 끄기 위한 타이머
 
-// 1kHz 소리 설정 (단위: 나노초)
+// 전역 PWM 번호 (pwm_mock 모듈 사용 시 로드 메시지에 나오는 번호)
+static int pwm_index = 0;
+module_param(pwm_index, int, 0444);
+MODULE_PARM_DESC(pwm_index, "global PWM number to request (0 = Pi PWM0)");
+
+// 시퀀서 타이머 선택: hrtimer(기본) 또는 jiffies timer_list (정확도 비교용)
+static bool use_hrtimer = true;
+module_param(use_hrtimer, bool, 0444);
+MODULE_PARM_DESC(use_hrtimer, "drive note sequences with hrtimer (1) or jiffies timer_list (0)");
+
+// 재생/근접 모드가 끝나고 이 시간이 지나면 PWM을 반납 (다음 소리 때 다시 요청)
+static int autosuspend_ms = 1000;
+module_param(autosuspend_ms, int, 0444);
+MODULE_PARM_DESC(autosuspend_ms, "idle time in ms before the PWM channel is released");
+
+// 런타임 PM 재개(pwm_request)에 걸린 시간
+static u32 resume_count;
+static u64 resume_last_ns, resume_max_ns;
+
+// 1kHz 소리 설정 (단위: 나노초) - int 하나만 쓰는 기존 방식의 기본음
 #define PWM_PERIOD_NS 1000000   // 1ms (1kHz)
 #define PWM_DUTY_NS   500000    // 0.5ms (Duty 50%)
 
-// 소리 끄기 콜백 함수
-void stop_buzzer_func(struct timer_list *t) {
+// ---- 음 시퀀서 ----
+// write() 한 번에 음표 배열을 받아 hrtimer로 음마다 PWM을 다시 설정한다.
+// int 하나(4바이트)를 쓰면 기존처럼 1kHz 단음으로 처리.
+struct buz_note {
+    __u16 freq_hz;   // 0 = 쉼표
+    __u8  duty_pct;  // 0~100 (0이면 50%)
+    __u8  rsvd;
+    __u16 dur_ms;    // 소리 길이
+    __u16 gap_ms;    // 다음 음까지 무음 구간
+};
+
+#define BUZ_MAX_NOTES 64
+
+// ---- 스케줄러 ----
+// 요청마다 우선순위와 정책을 가지며, 재생 중이면 제한된 큐에 우선순위 순으로 쌓인다.
+// 정책은 fd별로 ioctl로 지정 (기본: 우선순위 0, 선점 = 기존 write 덮어쓰기 동작)
+enum {
+    BUZ_POLICY_QUEUE,         // 재생 중이면 큐에 넣고 차례를 기다림
+    BUZ_POLICY_PREEMPT,       // 우선순위가 같거나 낮은 재생을 끊고 즉시 재생
+    BUZ_POLICY_DROP_IF_BUSY,  // 재생 중이면 버림
+};
+
+struct buz_policy {
+    __u8  prio;      // 클수록 우선
+    __u8  policy;    // BUZ_POLICY_*
+    __u16 rsvd;
+};
+
+struct buz_stats {
+    __u32 depth;      // 현재 대기 중인 요청 수
+    __u32 played;     // 끝까지 재생된 요청
+    __u32 dropped;    // 버려진 요청 (drop-if-busy, 큐 가득 참)
+    __u32 preempted;  // 재생 도중 선점당한 요청
+};
+
+// 근접 피드백: 로터리 위치와 목표값의 거리로 비프 간격을 커널에서 직접 만든다.
+// 간격 = dist * step_ms + base_ms (0 < dist < range 일 때만 울림)
+struct buz_prox {
+    __s16 target;    // 목표값
+    __s16 value;     // 현재값 (이후 로터리 한 칸마다 +-1, min~max로 제한)
+    __s16 min;
+    __s16 max;
+    __u16 range;     // 이 거리 이상이면 무음
+    __u16 base_ms;
+    __u16 step_ms;
+    __u16 beep_ms;
+};
+
+#define BUZ_IOC_MAGIC      'b'
+#define BUZ_IOC_WAIT       _IO(BUZ_IOC_MAGIC, 0)   // 재생이 끝날 때까지 대기
+#define BUZ_IOC_SET_POLICY _IOW(BUZ_IOC_MAGIC, 1, struct buz_policy)
+#define BUZ_IOC_GET_STATS  _IOR(BUZ_IOC_MAGIC, 2, struct buz_stats)
+#define BUZ_IOC_PROX_SET   _IOW(BUZ_IOC_MAGIC, 3, struct buz_prox)
+#define BUZ_IOC_PROX_OFF   _IO(BUZ_IOC_MAGIC, 4)
+
+#define BUZ_QUEUE_LEN 8
+
+struct buz_req {
+    u8 prio;
+    u16 count;        // 0 = 빈 슬롯
+    struct buz_note notes[BUZ_MAX_NOTES];
+};
+
+static struct buz_req req_pool[BUZ_QUEUE_LEN];
+static struct buz_req *queue[BUZ_QUEUE_LEN];   // 우선순위 내림차순, 같으면 도착순
+static int q_len;
+static struct buz_stats stats;
+
+static struct buz_note seq[BUZ_MAX_NOTES];
+static int seq_len, seq_pos;
+static u8 seq_prio;
+static bool seq_in_gap;          // 현재 음을 끝내고 쉬는 중
+static bool playing;             // 재생 중이거나 대기 요청이 있음
+static DEFINE_SPINLOCK(seq_lock);
+static DECLARE_WAIT_QUEUE_HEAD(done_wq);
+static struct hrtimer seq_timer;
+static struct timer_list seq_jtimer;  // use_hrtimer=0 일 때
+static unsigned long seq_jexpires;
+
+// debugfs (/sys/kernel/debug/safe_buzzer): stats 카운터 + 타이머 지연 히스토그램
+// 히스토그램은 stats에 1을 써야 기록 (카운터는 BUZ_IOC_GET_STATS용이라 항상 셈)
+static DEFINE_STATIC_KEY_FALSE(buz_stats);
+static struct safe_hist seq_late_hist;   // 시퀀서 타이머 만료 예정 -> 콜백 실행
+static struct dentry *buz_debugfs;
+
+// ---- PWM 적용 ----
+// pwm_apply_state()는 컨트롤러에 따라 잠들 수 있으므로 (bcm2835 등) 타이머/seq_lock 안에서는
+// 원하는 음만 기록하고, 실제 설정은 SCHED_FIFO kthread worker가 프로세스 문맥에서 한다.
+// worker가 돌기 전에 다시 바뀌면 마지막 값만 적용 (pwm_skipped로 셈).
+static struct kthread_worker *pwm_worker;
+static struct kthread_work pwm_work;
+static DEFINE_MUTEX(pwm_lock);       // pwm0 교체(런타임 PM)와 적용 사이
+static unsigned int pwm_freq, pwm_duty;  // 적용할 값 (seq_lock 보유 시 변경)
+static bool pwm_dirty;
+static u32 pwm_skipped;
+
+static void buz_pwm_work_fn(struct kthread_work *w) {
+    struct pwm_state state;
+    unsigned int freq_hz, duty_pct;
+    unsigned long flags;
+
+    mutex_lock(&pwm_lock);
+    spin_lock_irqsave(&seq_lock, flags);
+    freq_hz = pwm_freq;
+    duty_pct = pwm_duty;
+    pwm_dirty = false;
+    spin_unlock_irqrestore(&seq_lock, flags);
+
+    // 런타임 PM으로 PWM을 반납한 상태 (재생 중일 때는 항상 있음)
     if (pwm0) {
-        pwm_disable(pwm0);
+        pwm_get_state(pwm0, &state);
+        if (freq_hz) {
+            state.period = NSEC_PER_SEC / freq_hz;
+            state.duty_cycle = state.period * (duty_pct ? min(duty_pct, 100U) : 50) / 100;
+            state.enabled = true;
+        } else {
+            state.enabled = false;
+        }
+        pwm_apply_state(pwm0, &state);
     }
+    mutex_unlock(&pwm_lock);
 }
 
-static ssize_t driver_write(struct file *f, const char __user *u, size_t c, loff_t *o) {
-    int ms = 0;
-    struct pwm_state state; // 추가
+// 어느 문맥에서든 호출 가능 (seq_lock 보유)
+static void buz_apply(unsigned int freq_hz, unsigned int duty_pct) {
+    if (pwm_dirty)
+        pwm_skipped++;
+    pwm_freq = freq_hz;
+    pwm_duty = duty_pct;
+    pwm_dirty = true;
+    kthread_queue_work(pwm_worker, &pwm_work);
+}
 
-    if (copy_from_user(&ms, u, sizeof(int))) return -EFAULT;
+// 재생 완료 구독자 (safe_events 등)
+static ATOMIC_NOTIFIER_HEAD(buz_notifier);
 
-    // 현재 PWM 상태 가져오기
-    pwm_get_state(pwm0, &state);
+int safe_buzzer_register_notifier(struct notifier_block *nb) {
+    return atomic_notifier_chain_register(&buz_notifier, nb);
+}
+EXPORT_SYMBOL_GPL(safe_buzzer_register_notifier);
 
-    if (ms > 0) {
-        state.period = PWM_PERIOD_NS;
-        state.duty_cycle = PWM_DUTY_NS;
-        state.enabled = true;
-        pwm_apply_state(pwm0, &state); // 설정 적용
+int safe_buzzer_unregister_notifier(struct notifier_block *nb) {
+    return atomic_notifier_chain_unregister(&buz_notifier, nb);
+}
+EXPORT_SYMBOL_GPL(safe_buzzer_unregister_notifier);
 
-        mod_timer(&stop_timer, jiffies + msecs_to_jiffies(ms));
+// 재생이 시작/끝날 때 런타임 PM 참조를 잡고 놓음 (seq_lock 보유)
+// 시작은 write()나 근접 모드가 이미 장치를 깨워 둔 상태에서만 일어남
+static void buz_busy(bool on) {
+    if (on == playing)
+        return;
+    if (on) {
+        pm_runtime_get_noresume(buz_dev);
     } else {
-        state.enabled = false;
-        pwm_apply_state(pwm0, &state);
-        del_timer(&stop_timer);
+        pm_runtime_mark_last_busy(buz_dev);
+        pm_runtime_put_autosuspend(buz_dev);
+    }
+}
+
+// 재생 시퀀스 교체 (seq_lock 보유)
+static void buz_load(const struct buz_note *notes, int count, u8 prio) {
+    trace_buzzer_start(prio, count, notes[0].freq_hz);
+    buz_busy(true);
+    memcpy(seq, notes, count * sizeof(*notes));
+    seq_len = count;
+    seq_pos = 0;
+    seq_prio = prio;
+    seq_in_gap = false;
+    playing = true;
+}
+
+// 다음 상태로 진행. 다음 타이머까지의 ns 반환, 0이면 재생 종료 (seq_lock 보유)
+static u64 buz_step(void) {
+    const struct buz_note *n;
+    struct buz_req *r;
+
+    for (;;) {
+        while (seq_pos < seq_len) {
+            n = &seq[seq_pos];
+            if (!seq_in_gap) {
+                buz_apply(n->freq_hz, n->duty_pct);
+                seq_in_gap = true;
+                if (n->dur_ms)
+                    return (u64)n->dur_ms * NSEC_PER_MSEC;
+            }
+            // 음 종료: 쉼이 없으면 끊지 않고 바로 다음 음으로
+            seq_in_gap = false;
+            seq_pos++;
+            if (n->gap_ms) {
+                buz_apply(0, 0);
+                return (u64)n->gap_ms * NSEC_PER_MSEC;
+            }
+        }
+        if (seq_len) {
+            stats.played++;
+            seq_len = 0;
+            atomic_notifier_call_chain(&buz_notifier, SAFE_BUZZER_SEQ_DONE, (void *)(long)seq_prio);
+        }
+        if (!q_len)
+            break;
+
+        // 대기 요청을 틈 없이 바로 이어서 재생
+        r = queue[0];
+        q_len--;
+        memmove(&queue[0], &queue[1], q_len * sizeof(queue[0]));
+        buz_load(r->notes, r->count, r->prio);
+        r->count = 0;
+    }
+
+    buz_apply(0, 0);
+    trace_buzzer_stop(false);
+    atomic_notifier_call_chain(&buz_notifier, SAFE_BUZZER_IDLE, (void *)0L);
+    buz_busy(false);
+    playing = false;
+    wake_up_interruptible(&done_wq);
+    return 0;
+}
+
+// 지금부터 ns 뒤에 시퀀서 타이머를 검 (seq_lock 보유)
+// 콜백이 다른 CPU에서 도는 중이어도 타이머가 다시 큐잉되므로
+// 콜백은 큐에 올라가 있는지 보고 자기 차례가 아님을 알 수 있다.
+static void seq_arm(u64 ns) {
+    if (use_hrtimer) {
+        hrtimer_start(&seq_timer, ns_to_ktime(ns), HRTIMER_MODE_REL);
+    } else {
+        seq_jexpires = jiffies + nsecs_to_jiffies(ns);
+        mod_timer(&seq_jtimer, seq_jexpires);
+    }
+}
+
+static void seq_disarm(void) {
+    if (use_hrtimer)
+        hrtimer_try_to_cancel(&seq_timer);
+    else
+        del_timer(&seq_jtimer);
+}
+
+// 현재 시퀀스를 처음부터 시작 (seq_lock 보유)
+static void buz_kick(void) {
+    u64 ns = buz_step();
+
+    if (ns)
+        seq_arm(ns);
+    else
+        seq_disarm();
+}
+
+// 우선순위 순으로 큐에 삽입. 가득 차면 더 낮은 우선순위 하나를 밀어냄 (seq_lock 보유)
+static int buz_enqueue(const struct buz_note *notes, int count, u8 prio) {
+    struct buz_req *r = NULL;
+    int i, pos;
+
+    if (q_len == BUZ_QUEUE_LEN) {
+        if (queue[q_len - 1]->prio >= prio) {
+            stats.dropped++;
+            return -EBUSY;
+        }
+        q_len--;
+        queue[q_len]->count = 0;
+        stats.dropped++;
+    }
+
+    for (i = 0; i < BUZ_QUEUE_LEN; i++) {
+        if (!req_pool[i].count) {
+            r = &req_pool[i];
+            break;
+        }
+    }
+    memcpy(r->notes, notes, count * sizeof(*notes));
+    r->count = count;
+    r->prio = prio;
+
+    for (pos = 0; pos < q_len && queue[pos]->prio >= prio; pos++)
+        ;
+    memmove(&queue[pos + 1], &queue[pos], (q_len - pos) * sizeof(queue[0]));
+    queue[pos] = r;
+    q_len++;
+    return 0;
+}
+
+// 정책에 따라 즉시 재생 / 선점 / 대기 / 버림 (seq_lock 보유)
+static int buz_submit(const struct buz_note *notes, int count, const struct buz_policy *p) {
+    if (!playing) {
+        buz_load(notes, count, p->prio);
+        buz_kick();
+        return 0;
+    }
+
+    switch (p->policy) {
+    case BUZ_POLICY_DROP_IF_BUSY:
+        stats.dropped++;
+        return -EBUSY;
+    case BUZ_POLICY_PREEMPT:
+        if (p->prio >= seq_prio) {
+            if (seq_len)
+                stats.preempted++;
+            buz_load(notes, count, p->prio);
+            buz_kick();
+            return 0;
+        }
+        break;
+    }
+    return buz_enqueue(notes, count, p->prio);
+}
+
+static enum hrtimer_restart seq_timer_func(struct hrtimer *t) {
+    unsigned long flags;
+    u64 ns;
+
+    spin_lock_irqsave(&seq_lock, flags);
+    // 그 사이 write()가 새 시퀀스로 타이머를 다시 걸어 놓았거나
+    // buz_stop()이 이미 멈췄으면 (락 대기 중이던 콜백) 손대지 않음
+    if (hrtimer_is_queued(t) || !playing) {
+        spin_unlock_irqrestore(&seq_lock, flags);
+        return HRTIMER_NORESTART;
+    }
+    if (safe_stats_on(&buz_stats))
+        safe_hist_add(&seq_late_hist, max_t(s64, ktime_to_ns(ktime_sub(ktime_get(), hrtimer_get_expires(t))), 0));
+    ns = buz_step();
+    // 이전 만료 시각 기준으로 이어 붙여 누적 오차가 생기지 않게 함
+    if (ns)
+        hrtimer_set_expires(t, ktime_add_ns(hrtimer_get_expires(t), ns));
+    spin_unlock_irqrestore(&seq_lock, flags);
+
+    return ns ? HRTIMER_RESTART : HRTIMER_NORESTART;
+}
+
+static void seq_jtimer_func(struct timer_list *t) {
+    unsigned long flags;
+    u64 ns;
+
+    spin_lock_irqsave(&seq_lock, flags);
+    if (!timer_pending(t) && playing) {
+        if (safe_stats_on(&buz_stats))
+            safe_hist_add(&seq_late_hist, jiffies_to_nsecs(jiffies - seq_jexpires));
+        ns = buz_step();
+        // hrtimer 경로와 같이 이전 만료 시각 기준 (단, jiffies 단위로 잘림)
+        if (ns) {
+            seq_jexpires += nsecs_to_jiffies(ns);
+            mod_timer(t, seq_jexpires);
+        }
+    }
+    spin_unlock_irqrestore(&seq_lock, flags);
+}
+
+// ---- 근접 피드백 엔진 ----
+// 힌트 비프는 가장 낮은 우선순위로, 다른 소리가 나는 중이면 버려짐
+// (사용자 요청이 아니므로 stats.dropped 대신 prox_skipped로 셈)
+static const struct buz_policy prox_policy = { .prio = 0, .policy = BUZ_POLICY_DROP_IF_BUSY };
+static u32 prox_skipped;
+
+static struct buz_prox prox;
+static bool prox_on;
+static ktime_t prox_last;        // 마지막 힌트 비프 시각
+static DEFINE_SPINLOCK(prox_lock);
+static struct hrtimer prox_timer;
+
+// 현재 거리에 해당하는 간격(ns), 울리지 않을 거리면 0 (prox_lock 보유)
+static u64 prox_interval(void) {
+    int dist = abs(prox.target - prox.value);
+
+    if (dist <= 0 || dist >= prox.range)
+        return 0;
+    return ((u64)dist * prox.step_ms + prox.base_ms) * NSEC_PER_MSEC;
+}
+
+// 마지막 비프 기준으로 다음 비프 시각을 다시 잡음 (prox_lock 보유)
+static void prox_rearm(void) {
+    u64 ns = prox_interval();
+
+    if (ns)
+        hrtimer_start(&prox_timer, ktime_add_ns(prox_last, ns), HRTIMER_MODE_ABS);
+    else
+        hrtimer_try_to_cancel(&prox_timer);
+}
+
+static enum hrtimer_restart prox_timer_func(struct hrtimer *t) {
+    struct buz_note one = { .freq_hz = NSEC_PER_SEC / PWM_PERIOD_NS };
+    unsigned long flags;
+    u64 ns;
+
+    spin_lock_irqsave(&prox_lock, flags);
+    // 로터리 이벤트로 이미 다시 걸렸거나 꺼진 경우
+    if (!prox_on || hrtimer_is_queued(t)) {
+        spin_unlock_irqrestore(&prox_lock, flags);
+        return HRTIMER_NORESTART;
+    }
+    ns = prox_interval();
+    if (ns) {
+        one.dur_ms = prox.beep_ms;
+        spin_lock(&seq_lock);
+        if (playing)
+            prox_skipped++;
+        else
+            buz_submit(&one, 1, &prox_policy);
+        spin_unlock(&seq_lock);
+
+        prox_last = ktime_get();
+        hrtimer_set_expires(t, ktime_add_ns(prox_last, ns));
+    }
+    spin_unlock_irqrestore(&prox_lock, flags);
+
+    return ns ? HRTIMER_RESTART : HRTIMER_NORESTART;
+}
+
+// 로터리 한 칸마다 hardirq/타이머 문맥(rt_prio 모드나 잠드는 GPIO면 커널 스레드)에서 호출
+static int prox_rotary_event(struct notifier_block *nb, unsigned long evt, void *data) {
+    unsigned long flags;
+
+    if (evt != SAFE_ROTARY_STEP)
+        return NOTIFY_DONE;
+
+    spin_lock_irqsave(&prox_lock, flags);
+    if (prox_on) {
+        prox.value = clamp_t(int, prox.value + (long)data, prox.min, prox.max);
+        prox_rearm();
     }
-    return c;
+    spin_unlock_irqrestore(&prox_lock, flags);
+    return NOTIFY_OK;
+}
+
+static struct notifier_block prox_nb = {
+    .notifier_call = prox_rotary_event,
+};
+
+// 근접 모드가 켜져 있는 동안은 런타임 PM 참조를 하나 잡아 둠
+static int prox_set(const struct buz_prox *np) {
+    unsigned long flags;
+    bool was_on;
+    int ret;
+
+    if (np->min > np->max || !np->beep_ms)
+        return -EINVAL;
+
+    ret = pm_runtime_resume_and_get(buz_dev);
+    if (ret)
+        return ret;
+
+    spin_lock_irqsave(&prox_lock, flags);
+    was_on = prox_on;
+    prox = *np;
+    prox.value = clamp(prox.value, prox.min, prox.max);
+    // 처음 켤 때만 기준 시각을 잡고, 목표만 바뀌는 경우는 비프 간격을 이어감
+    if (!prox_on)
+        prox_last = ktime_get();
+    prox_on = true;
+    prox_rearm();
+    spin_unlock_irqrestore(&prox_lock, flags);
+
+    // 이미 켜져 있었으면 참조는 하나만 유지
+    if (was_on)
+        pm_runtime_put_noidle(buz_dev);
+    return 0;
 }
 
-static struct file_operations fops = { .owner=THIS_MODULE, .write=driver_write };
+static void prox_off(void) {
+    unsigned long flags;
+    bool was_on;
+
+    spin_lock_irqsave(&prox_lock, flags);
+    was_on = prox_on;
+    prox_on = false;
+    hrtimer_try_to_cancel(&prox_timer);
+    spin_unlock_irqrestore(&prox_lock, flags);
+
+    if (was_on) {
+        pm_runtime_mark_last_busy(buz_dev);
+        pm_runtime_put_autosuspend(buz_dev);
+    }
+}
+
+// 재생 중인 것과 대기열을 모두 비움
+static void buz_stop(void) {
+    unsigned long flags;
+    int i;
+
+    spin_lock_irqsave(&seq_lock, flags);
+    for (i = 0; i < q_len; i++)
+        queue[i]->count = 0;
+    q_len = 0;
+    seq_len = 0;
+    seq_pos = 0;
+    seq_disarm();
+    buz_apply(0, 0);
+    if (playing) {
+        trace_buzzer_stop(true);
+        atomic_notifier_call_chain(&buz_notifier, SAFE_BUZZER_IDLE, (void *)1L);
+    }
+    buz_busy(false);
+    playing = false;
+    wake_up_interruptible(&done_wq);
+    spin_unlock_irqrestore(&seq_lock, flags);
+}
+
+static int driver_open(struct inode *inode, struct file *f) {
+    struct buz_policy *p = kzalloc(sizeof(*p), GFP_KERNEL);
+
+    if (!p) return -ENOMEM;
+    p->policy = BUZ_POLICY_PREEMPT;
+    f->private_data = p;
+    return 0;
+}
+
+static int driver_release(struct inode *inode, struct file *f) {
+    kfree(f->private_data);
+    return 0;
+}
+
+static ssize_t driver_write(struct file *f, const char __user *u, size_t c, loff_t *o) {
+    struct buz_policy *p = f->private_data;
+    struct buz_note *notes;
+    unsigned long flags;
+    int ms = 0, ret;
+
+    // 기존 형식: int 하나 = 1kHz 단음 길이(ms), 0 이하면 정지
+    if (c == sizeof(int)) {
+        struct buz_note one = {
+            .freq_hz = NSEC_PER_SEC / PWM_PERIOD_NS,
+            .duty_pct = PWM_DUTY_NS * 100 / PWM_PERIOD_NS,
+        };
+
+        if (copy_from_user(&ms, u, sizeof(int))) return -EFAULT;
+
+        if (ms <= 0) {
+            buz_stop();
+            return c;
+        }
+        one.dur_ms = min(ms, (int)U16_MAX);
+
+        ret = pm_runtime_resume_and_get(buz_dev);
+        if (ret) return ret;
+        spin_lock_irqsave(&seq_lock, flags);
+        ret = buz_submit(&one, 1, p);
+        spin_unlock_irqrestore(&seq_lock, flags);
+        pm_runtime_mark_last_busy(buz_dev);
+        pm_runtime_put_autosuspend(buz_dev);
+        return ret ? ret : c;
+    }
+
+    // 음표 배열
+    if (c == 0 || c % sizeof(struct buz_note) || c / sizeof(struct buz_note) > BUZ_MAX_NOTES)
+        return -EINVAL;
+
+    notes = memdup_user(u, c);
+    if (IS_ERR(notes)) return PTR_ERR(notes);
+
+    ret = pm_runtime_resume_and_get(buz_dev);
+    if (ret) {
+        kfree(notes);
+        return ret;
+    }
+    spin_lock_irqsave(&seq_lock, flags);
+    ret = buz_submit(notes, c / sizeof(struct buz_note), p);
+    spin_unlock_irqrestore(&seq_lock, flags);
+    pm_runtime_mark_last_busy(buz_dev);
+    pm_runtime_put_autosuspend(buz_dev);
+
+    kfree(notes);
+    return ret ? ret : c;
+}
+
+// 재생이 끝나 있으면 POLLOUT
+static __poll_t driver_poll(struct file *f, poll_table *wait) {
+    poll_wait(f, &done_wq, wait);
+    return READ_ONCE(playing) ? 0 : EPOLLOUT | EPOLLWRNORM;
+}
+
+static long driver_ioctl(struct file *f, unsigned int cmd, unsigned long arg) {
+    struct buz_policy *p = f->private_data;
+    struct buz_policy np;
+    struct buz_stats st;
+    struct buz_prox pr;
+    unsigned long flags;
+
+    switch (cmd) {
+    case BUZ_IOC_WAIT:
+        return wait_event_interruptible(done_wq, !READ_ONCE(playing));
+    case BUZ_IOC_SET_POLICY:
+        if (copy_from_user(&np, (void __user *)arg, sizeof(np))) return -EFAULT;
+        if (np.policy > BUZ_POLICY_DROP_IF_BUSY) return -EINVAL;
+        *p = np;
+        return 0;
+    case BUZ_IOC_GET_STATS:
+        spin_lock_irqsave(&seq_lock, flags);
+        st = stats;
+        st.depth = q_len;
+        spin_unlock_irqrestore(&seq_lock, flags);
+        if (copy_to_user((void __user *)arg, &st, sizeof(st))) return -EFAULT;
+        return 0;
+    case BUZ_IOC_PROX_SET:
+        if (copy_from_user(&pr, (void __user *)arg, sizeof(pr))) return -EFAULT;
+        return prox_set(&pr);
+    case BUZ_IOC_PROX_OFF:
+        prox_off();
+        return 0;
+    default:
+        return -ENOTTY;
+    }
+}
+
+// ---- 런타임 PM ----
+// 쉬는 동안에는 PWM 채널을 반납하고, 다음 write()/근접 모드에서 다시 요청
+static int buz_runtime_suspend(struct device *dev) {
+    struct pwm_device *p;
+
+    mutex_lock(&pwm_lock);
+    p = pwm0;
+    pwm0 = NULL;
+    mutex_unlock(&pwm_lock);
+
+    if (p) {
+        pwm_disable(p);
+        pwm_free(p);
+    }
+    return 0;
+}
+
+static int buz_runtime_resume(struct device *dev) {
+    ktime_t start = ktime_get();
+    struct pwm_device *p;
+    u64 ns;
+
+    p = pwm_request(pwm_index, "safe_pwm");
+    if (IS_ERR(p))
+        return PTR_ERR(p);
+
+    mutex_lock(&pwm_lock);
+    pwm0 = p;
+    mutex_unlock(&pwm_lock);
+
+    ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+    resume_count++;
+    resume_last_ns = ns;
+    resume_max_ns = max(resume_max_ns, ns);
+    return 0;
+}
+
+static const struct dev_pm_ops buz_pm_ops = {
+    SET_RUNTIME_PM_OPS(buz_runtime_suspend, buz_runtime_resume, NULL)
+};
+
+static ssize_t resume_stats_show(struct device *dev, struct device_attribute *attr, char *buf) {
+    return sysfs_emit(buf, "count=%u last_us=%llu max_us=%llu\n", resume_count,
+                      div_u64(resume_last_ns, NSEC_PER_USEC), div_u64(resume_max_ns, NSEC_PER_USEC));
+}
+static DEVICE_ATTR_RO(resume_stats);
+
+static struct file_operations fops = {
+    .owner = THIS_MODULE,
+    .open = driver_open,
+    .release = driver_release,
+    .write = driver_write,
+    .poll = driver_poll,
+    .unlocked_ioctl = driver_ioctl,
+};
 
 static int __init safe_pwm_init(void) {
-    alloc_chrdev_region(&dev_num, 0, 1, DRIVER_NAME);
-    cdev_init(&cdev, &fops); cdev_add(&cdev, dev_num, 1);
+    int ret;
+
+    ret = alloc_chrdev_region(&dev_num, 0, 1, DRIVER_NAME);
+    if (ret)
+        return ret;
+    cdev_init(&cdev, &fops);
+    ret = cdev_add(&cdev, dev_num, 1);
+    if (ret)
+        goto err_region;
     cls = class_create(THIS_MODULE, "pwm_buzzer_class");
-    device_create(cls, NULL, dev_num, NULL, DRIVER_NAME);
+    if (IS_ERR(cls)) {
+        ret = PTR_ERR(cls);
+        goto err_cdev;
+    }
+    cls->pm = &buz_pm_ops;
+    buz_dev = device_create(cls, NULL, dev_num, NULL, DRIVER_NAME);
+    if (IS_ERR(buz_dev)) {
+        ret = PTR_ERR(buz_dev);
+        goto err_class;
+    }
 
-    pwm0 = pwm_request(0, "safe_pwm");
+    // pwm_index가 틀렸거나 pwm_mock이 없으면 여기서 실패 (위에서 만든 것은 모두 되돌림)
+    pwm0 = pwm_request(pwm_index, "safe_pwm");
     if (IS_ERR(pwm0)) {
+        ret = PTR_ERR(pwm0);
+        pwm0 = NULL;
         printk("PWM request failed!\n");
-        return PTR_ERR(pwm0);
+        goto err_device;
     }
 
-    timer_setup(&stop_timer, stop_buzzer_func, 0);
+    pwm_worker = kthread_create_worker(0, "safe_buzzer_pwm");
+    if (IS_ERR(pwm_worker)) {
+        ret = PTR_ERR(pwm_worker);
+        goto err_pwm;
+    }
+    kthread_init_work(&pwm_work, buz_pwm_work_fn);
+    // 음 길이 정확도가 worker 깨어나는 지연에 달려 있으므로 실시간 우선순위
+    sched_set_fifo(pwm_worker->task);
+
+    hrtimer_init(&seq_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    seq_timer.function = seq_timer_func;
+    timer_setup(&seq_jtimer, seq_jtimer_func, 0);
+    hrtimer_init(&prox_timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+    prox_timer.function = prox_timer_func;
+    safe_rotary_register_notifier(&prox_nb);
+
+    pm_runtime_set_active(buz_dev);
+    pm_runtime_set_autosuspend_delay(buz_dev, autosuspend_ms);
+    pm_runtime_use_autosuspend(buz_dev);
+    pm_runtime_enable(buz_dev);
+    pm_runtime_mark_last_busy(buz_dev);
+    pm_request_autosuspend(buz_dev);
+    device_create_file(buz_dev, &dev_attr_resume_stats);
+
+    buz_debugfs = debugfs_create_dir(DRIVER_NAME, NULL);
+    debugfs_create_u32("played", 0444, buz_debugfs, &stats.played);
+    debugfs_create_u32("dropped", 0444, buz_debugfs, &stats.dropped);
+    debugfs_create_u32("preempted", 0444, buz_debugfs, &stats.preempted);
+    debugfs_create_u32("pwm_skipped", 0444, buz_debugfs, &pwm_skipped);
+    debugfs_create_u32("prox_skipped", 0444, buz_debugfs, &prox_skipped);
+    safe_hist_debugfs("seq_late_hist", buz_debugfs, &seq_late_hist);
+    safe_stats_debugfs(buz_debugfs, &buz_stats);
     return 0;
+
+err_pwm:
+    pwm_free(pwm0);
+    pwm0 = NULL;
+err_device:
+    device_destroy(cls, dev_num);
+err_class:
+    class_destroy(cls);
+err_cdev:
+    cdev_del(&cdev);
+err_region:
+    unregister_chrdev_region(dev_num, 1);
+    return ret;
 }
 
 static void __exit safe_pwm_exit(void) {
+    debugfs_remove_recursive(buz_debugfs);
+    safe_rotary_unregister_notifier(&prox_nb);
+    prox_off();
+    hrtimer_cancel(&prox_timer);
+    hrtimer_cancel(&seq_timer);
+    del_timer_sync(&seq_jtimer);
+    kthread_destroy_worker(pwm_worker);   // 남은 적용을 마치고 종료
+    device_remove_file(buz_dev, &dev_attr_resume_stats);
+    pm_runtime_disable(buz_dev);
+    pm_runtime_dont_use_autosuspend(buz_dev);
     if (pwm0) {
         pwm_disable(pwm0);
         pwm_free(pwm0);
     }
-    del_timer_sync(&stop_timer);
     device_destroy(cls, dev_num); class_destroy(cls); cdev_del(&cdev); unregister_chrdev_region(dev_num, 1);
 }
 
 module_init(safe_pwm_init);
-module_exit(safe_pwm_exit);
\ No newline at end of file
+module_exit(safe_pwm_exit);
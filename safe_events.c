@@ -0,0 +1,249 @@
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/miscdevice.h>
+#include <linux/fs.h>
+#include <linux/kfifo.h>
+#include <linux/list.h>
+#include <linux/mutex.h>
+#include <linux/poll.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/wait.h>
+#include <linux/ktime.h>
+#include <linux/uaccess.h>
+
+#include "safe_rotary.h"
+#include "safe_events.h"
+
+// 로터리/버튼, RTC 초 틱, 부저 재생 완료를 /dev/safe_events 하나로 모은다.
+// 여는 fd마다 자기 큐를 가지며, 모든 이벤트를 각 큐에 복사해 넣는다.
+// 이벤트는 struct safe_event (16바이트) 단위. read() 한 번에 쌓인 것을 버퍼 크기만큼 전부 돌려줌.
+// RTC 틱은 fd마다 켜야 받으며 (앱은 메뉴 화면에서만), 켜 둔 fd가 있는 동안만 DS1302를 읽는다.
+
+#define EVT_QUEUE_LEN 256   // fd당 (2의 거듭제곱)
+
+struct evt_reader {
+    struct list_head node;
+    u32 mask;               // SAFE_EVT_BIT() 조합 (readers_lock 아래에서 변경)
+    DECLARE_KFIFO(fifo, struct safe_event, EVT_QUEUE_LEN);
+    u32 dropped;            // 큐가 가득 차 버린 수 (다음 빈 자리에 OVERFLOW로 알림)
+    struct mutex read_lock; // 같은 fd를 여러 스레드가 읽는 경우
+};
+
+static LIST_HEAD(readers);
+static DEFINE_SPINLOCK(readers_lock);   // 이벤트 넣기 (hardirq 문맥 포함)
+static DEFINE_MUTEX(open_lock);         // 틱 구독 관리
+static DECLARE_WAIT_QUEUE_HEAD(evt_wq);
+static int n_tick;                      // RTC_TICK을 켠 fd 수 (open_lock)
+
+// 모든 열린 fd의 큐에 이벤트 하나 추가 (어느 문맥에서든 호출 가능)
+static void evt_push(u16 type, s32 value)
+{
+    struct safe_event e = { .type = type, .value = value, .ts_ns = ktime_get_ns() };
+    struct evt_reader *r;
+    unsigned long flags;
+
+    spin_lock_irqsave(&readers_lock, flags);
+    list_for_each_entry(r, &readers, node) {
+        if (!(r->mask & SAFE_EVT_BIT(type)))
+            continue;
+        // 밀린 OVERFLOW 알림 먼저 (이벤트까지 들어갈 자리가 있을 때만)
+        if (r->dropped && kfifo_avail(&r->fifo) >= 2) {
+            struct safe_event ov = { .type = SAFE_EVT_OVERFLOW, .value = r->dropped, .ts_ns = e.ts_ns };
+
+            kfifo_put(&r->fifo, ov);
+            r->dropped = 0;
+        }
+        if (r->dropped || !kfifo_put(&r->fifo, e))
+            r->dropped++;
+    }
+    spin_unlock_irqrestore(&readers_lock, flags);
+
+    wake_up_interruptible(&evt_wq);
+}
+
+// ---- 이벤트 출처 ----
+static int evt_rotary(struct notifier_block *nb, unsigned long evt, void *data)
+{
+    if (evt == SAFE_ROTARY_STEP)
+        evt_push(SAFE_EVT_ROTARY, (long)data);
+    else if (evt == SAFE_ROTARY_BUTTON)
+        evt_push((long)data == 2 ? SAFE_EVT_BTN_LONG : SAFE_EVT_BTN_SHORT, 0);
+    return NOTIFY_OK;
+}
+
+static int evt_rtc_tick(struct notifier_block *nb, unsigned long evt, void *data)
+{
+    evt_push(SAFE_EVT_RTC_TICK, (long)data);
+    return NOTIFY_OK;
+}
+
+static int evt_buzzer(struct notifier_block *nb, unsigned long evt, void *data)
+{
+    evt_push(evt == SAFE_BUZZER_SEQ_DONE ? SAFE_EVT_BUZ_DONE : SAFE_EVT_BUZ_IDLE, (long)data);
+    return NOTIFY_OK;
+}
+
+static struct notifier_block rotary_nb = { .notifier_call = evt_rotary };
+static struct notifier_block rtc_nb = { .notifier_call = evt_rtc_tick };
+static struct notifier_block buzzer_nb = { .notifier_call = evt_buzzer };
+
+// fd 하나의 마스크 변경. RTC_TICK을 켠 첫 fd가 생기면 틱을 구독하고 마지막 fd가 끄면 해지
+static int evt_set_mask(struct evt_reader *r, u32 mask)
+{
+    bool want = mask & SAFE_EVT_BIT(SAFE_EVT_RTC_TICK);
+    bool had = r->mask & SAFE_EVT_BIT(SAFE_EVT_RTC_TICK);
+    unsigned long flags;
+    int ret;
+
+    mutex_lock(&open_lock);
+    if (want && !had && n_tick == 0) {
+        // RTC가 없으면 (ds1302 SPI 백엔드 probe 전 등) 마스크를 바꾸지 않음
+        ret = ds1302_register_tick_notifier(&rtc_nb);
+        if (ret) {
+            mutex_unlock(&open_lock);
+            return ret;
+        }
+    }
+    if (want && !had)
+        n_tick++;
+    else if (!want && had && --n_tick == 0)
+        ds1302_unregister_tick_notifier(&rtc_nb);
+
+    spin_lock_irqsave(&readers_lock, flags);
+    r->mask = mask;
+    spin_unlock_irqrestore(&readers_lock, flags);
+    mutex_unlock(&open_lock);
+    return 0;
+}
+
+// ---- 파일 연산 ----
+static int evt_open(struct inode *inode, struct file *f)
+{
+    struct evt_reader *r = kzalloc(sizeof(*r), GFP_KERNEL);
+    unsigned long flags;
+
+    if (!r)
+        return -ENOMEM;
+    INIT_KFIFO(r->fifo);
+    mutex_init(&r->read_lock);
+    r->mask = SAFE_EVT_MASK_DEFAULT;
+
+    spin_lock_irqsave(&readers_lock, flags);
+    list_add_tail(&r->node, &readers);
+    spin_unlock_irqrestore(&readers_lock, flags);
+
+    f->private_data = r;
+    return 0;
+}
+
+static int evt_release(struct inode *inode, struct file *f)
+{
+    struct evt_reader *r = f->private_data;
+    unsigned long flags;
+
+    evt_set_mask(r, 0);
+    spin_lock_irqsave(&readers_lock, flags);
+    list_del(&r->node);
+    spin_unlock_irqrestore(&readers_lock, flags);
+
+    kfree(r);
+    return 0;
+}
+
+static long evt_ioctl(struct file *f, unsigned int cmd, unsigned long arg)
+{
+    u32 mask;
+
+    if (cmd != SAFE_EVT_IOC_SET_MASK)
+        return -ENOTTY;
+    if (get_user(mask, (u32 __user *)arg))
+        return -EFAULT;
+    return evt_set_mask(f->private_data, mask);
+}
+
+static ssize_t evt_read(struct file *f, char __user *u, size_t c, loff_t *o)
+{
+    struct evt_reader *r = f->private_data;
+    unsigned int copied;
+    int ret;
+
+    if (c < sizeof(struct safe_event))
+        return -EINVAL;
+
+    if (mutex_lock_interruptible(&r->read_lock))
+        return -ERESTARTSYS;
+
+    while (kfifo_is_empty(&r->fifo)) {
+        mutex_unlock(&r->read_lock);
+        if (f->f_flags & O_NONBLOCK)
+            return -EAGAIN;
+        ret = wait_event_interruptible(evt_wq, !kfifo_is_empty(&r->fifo));
+        if (ret)
+            return ret;
+        if (mutex_lock_interruptible(&r->read_lock))
+            return -ERESTARTSYS;
+    }
+
+    // 넣는 쪽은 readers_lock으로 하나뿐, 꺼내는 쪽은 read_lock으로 하나뿐이라 kfifo만으로 안전
+    ret = kfifo_to_user(&r->fifo, u, rounddown(c, sizeof(struct safe_event)), &copied);
+    mutex_unlock(&r->read_lock);
+
+    return ret ? ret : copied;
+}
+
+static __poll_t evt_poll(struct file *f, poll_table *wait)
+{
+    struct evt_reader *r = f->private_data;
+
+    poll_wait(f, &evt_wq, wait);
+    return kfifo_is_empty(&r->fifo) ? 0 : EPOLLIN | EPOLLRDNORM;
+}
+
+static const struct file_operations evt_fops = {
+    .owner   = THIS_MODULE,
+    .open    = evt_open,
+    .release = evt_release,
+    .read    = evt_read,
+    .poll    = evt_poll,
+    .unlocked_ioctl = evt_ioctl,
+    .compat_ioctl   = evt_ioctl,
+    .llseek  = noop_llseek,
+};
+
+static struct miscdevice evt_misc = {
+    .minor = MISC_DYNAMIC_MINOR,
+    .name  = "safe_events",
+    .fops  = &evt_fops,
+    .mode  = 0666,
+};
+
+static int __init safe_events_init(void)
+{
+    int ret;
+
+    ret = misc_register(&evt_misc);
+    if (ret)
+        return ret;
+
+    safe_rotary_register_notifier(&rotary_nb);
+    safe_buzzer_register_notifier(&buzzer_nb);
+
+    pr_info("safe_events: /dev/safe_events ready\n");
+    return 0;
+}
+
+static void __exit safe_events_exit(void)
+{
+    safe_buzzer_unregister_notifier(&buzzer_nb);
+    safe_rotary_unregister_notifier(&rotary_nb);
+    misc_deregister(&evt_misc);
+}
+
+module_init(safe_events_init);
+module_exit(safe_events_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_AUTHOR("kkk");
+MODULE_DESCRIPTION("Multiplexed event stream for rotary, RTC tick and buzzer completion (/dev/safe_events)");
@@ -0,0 +1,55 @@
+#ifndef SAFE_EVENTS_H
+#define SAFE_EVENTS_H
+
+#include <linux/types.h>
+#include <linux/ioctl.h>
+
+// /dev/safe_events 이벤트 스트림 (safe_events 모듈, 앱과 공용)
+// read()는 struct safe_event 단위로, 버퍼에 들어가는 만큼 한 번에 돌려준다.
+// O_NONBLOCK이 아니면 이벤트가 하나라도 생길 때까지 기다림. poll()은 EPOLLIN.
+// 받을 종류는 fd마다 SAFE_EVT_IOC_SET_MASK로 고른다. RTC_TICK은 기본으로 꺼져 있고,
+// 켜 둔 fd가 하나라도 있는 동안만 DS1302를 주기적으로 읽는다.
+
+enum {
+    SAFE_EVT_ROTARY,     // value = +1 / -1 (한 칸)
+    SAFE_EVT_BTN_SHORT,
+    SAFE_EVT_BTN_LONG,
+    SAFE_EVT_RTC_TICK,   // value = 하루 중 초 (hour * 3600 + min * 60 + sec)
+    SAFE_EVT_BUZ_DONE,   // 시퀀스 하나 재생 완료, value = 우선순위
+    SAFE_EVT_BUZ_IDLE,   // 부저가 조용해짐, value = 1 이면 정지 요청으로 끊김
+    SAFE_EVT_OVERFLOW,   // 읽기가 늦어 버린 이벤트가 있음, value = 버린 수
+};
+
+#define SAFE_EVT_BIT(type)    (1u << (type))
+// 열었을 때 기본값: RTC_TICK을 뺀 전부 (OVERFLOW는 마스크와 관계없이 항상 전달)
+#define SAFE_EVT_MASK_DEFAULT (~SAFE_EVT_BIT(SAFE_EVT_RTC_TICK))
+
+#define SAFE_EVT_IOC_MAGIC    'e'
+#define SAFE_EVT_IOC_SET_MASK _IOW(SAFE_EVT_IOC_MAGIC, 0, __u32)   // RTC가 없으면 RTC_TICK 켜기는 ENODEV
+
+struct safe_event {
+    __u16 type;       // SAFE_EVT_*
+    __u16 rsvd;
+    __s32 value;
+    __u64 ts_ns;      // 이벤트 발생 시각 (CLOCK_MONOTONIC)
+};
+
+#ifdef __KERNEL__
+#include <linux/notifier.h>
+
+// ds1302: 초가 바뀔 때마다 (workqueue 문맥, status_ms 주기로 확인)
+// data = (long)하루 중 초. 구독자가 있는 동안만 DS1302를 주기적으로 읽는다.
+int ds1302_register_tick_notifier(struct notifier_block *nb);
+int ds1302_unregister_tick_notifier(struct notifier_block *nb);
+
+// safe_buzzer: 재생 완료 알림 (seq_lock 보유, hardirq 문맥일 수 있음, 잠들면 안 됨)
+enum {
+    SAFE_BUZZER_SEQ_DONE,   // data = (long)우선순위
+    SAFE_BUZZER_IDLE,       // data = (long)1 이면 정지 요청
+};
+
+int safe_buzzer_register_notifier(struct notifier_block *nb);
+int safe_buzzer_unregister_notifier(struct notifier_block *nb);
+#endif
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef SAFE_HIST_H
+#define SAFE_HIST_H
+
+#include <linux/atomic.h>
+#include <linux/debugfs.h>
+#include <linux/fs.h>
+#include <linux/jump_label.h>
+#include <linux/kstrtox.h>
+#include <linux/ktime.h>
+#include <linux/log2.h>
+#include <linux/math64.h>
+#include <linux/seq_file.h>
+
+// debugfs용 log2 지연 히스토그램 (드라이버 공용)
+// 칸 i = [2^i, 2^(i+1)) ns. 어느 문맥에서든 safe_hist_add()로 기록하고,
+// 파일을 읽으면 칸별 개수, 쓰면(아무 값) 초기화.
+
+#define SAFE_HIST_BUCKETS 32   // 마지막 칸은 2^31 ns(약 2초) 이상 전부
+
+struct safe_hist {
+    atomic_t bucket[SAFE_HIST_BUCKETS];
+    atomic64_t sum_ns;
+};
+
+static inline void safe_hist_add(struct safe_hist *h, u64 ns)
+{
+    int b = ns ? min_t(int, ilog2(ns), SAFE_HIST_BUCKETS - 1) : 0;
+
+    atomic_inc(&h->bucket[b]);
+    atomic64_add(ns, &h->sum_ns);
+}
+
+static int safe_hist_show(struct seq_file *m, void *v)
+{
+    struct safe_hist *h = m->private;
+    u64 n = 0;
+    int i, c;
+
+    for (i = 0; i < SAFE_HIST_BUCKETS; i++) {
+        c = atomic_read(&h->bucket[i]);
+        if (!c)
+            continue;
+        n += c;
+        seq_printf(m, "%12llu ns : %u\n", 1ULL << i, c);
+    }
+    seq_printf(m, "count %llu avg_ns %llu\n", n,
+               n ? div64_u64(atomic64_read(&h->sum_ns), n) : 0);
+    return 0;
+}
+
+static int safe_hist_open(struct inode *inode, struct file *f)
+{
+    return single_open(f, safe_hist_show, inode->i_private);
+}
+
+static ssize_t safe_hist_write(struct file *f, const char __user *u, size_t c, loff_t *o)
+{
+    struct safe_hist *h = ((struct seq_file *)f->private_data)->private;
+    int i;
+
+    for (i = 0; i < SAFE_HIST_BUCKETS; i++)
+        atomic_set(&h->bucket[i], 0);
+    atomic64_set(&h->sum_ns, 0);
+    return c;
+}
+
+static const struct file_operations safe_hist_fops = {
+    .owner   = THIS_MODULE,
+    .open    = safe_hist_open,
+    .read    = seq_read,
+    .llseek  = seq_lseek,
+    .write   = safe_hist_write,
+    .release = single_release,
+};
+
+static inline void safe_hist_debugfs(const char *name, struct dentry *dir, struct safe_hist *h)
+{
+    debugfs_create_file(name, 0644, dir, h, &safe_hist_fops);
+}
+
+// 통계 스위치: 드라이버마다 static key 하나 (기본 꺼짐).
+// 꺼져 있으면 시각 측정, 히스토그램, 카운터가 패치된 nop 하나로 빠진다.
+// <드라이버 debugfs>/stats 에 1을 쓰면 켜고 0이면 끔 (트레이스포인트는 따로 켬)
+#define safe_stats_on(key)    static_branch_unlikely(key)
+#define safe_stats_ktime(key) (safe_stats_on(key) ? ktime_get() : 0)
+
+static ssize_t safe_stats_read(struct file *f, char __user *u, size_t c, loff_t *o)
+{
+    struct static_key_false *key = f->private_data;
+    char buf[2] = { static_key_enabled(&key->key) ? '1' : '0', '\n' };
+
+    return simple_read_from_buffer(u, c, o, buf, sizeof(buf));
+}
+
+static ssize_t safe_stats_write(struct file *f, const char __user *u, size_t c, loff_t *o)
+{
+    struct static_key_false *key = f->private_data;
+    bool on;
+    int ret;
+
+    ret = kstrtobool_from_user(u, c, &on);
+    if (ret)
+        return ret;
+    if (on)
+        static_branch_enable(key);
+    else
+        static_branch_disable(key);
+    return c;
+}
+
+static const struct file_operations safe_stats_fops = {
+    .owner  = THIS_MODULE,
+    .open   = simple_open,
+    .read   = safe_stats_read,
+    .write  = safe_stats_write,
+    .llseek = default_llseek,
+};
+
+static inline void safe_stats_debugfs(struct dentry *dir, struct static_key_false *key)
+{
+    debugfs_create_file("stats", 0644, dir, key, &safe_stats_fops);
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef SAFE_LOGIC_H
+#define SAFE_LOGIC_H
+
+// 하드웨어와 무관한 계산 로직 (드라이버, 앱, logic_bench 공용)
+// 커널/유저 양쪽에서 그대로 컴파일되도록 static inline + __u8 등 UAPI 타입만 사용.
+
+#ifdef __KERNEL__
+#include <linux/types.h>
+#else
+#include <stddef.h>
+#include <linux/types.h>
+#endif
+
+// ---- DS1302: BCD 변환 ----
+static inline __u8 safe_bcd2dec(__u8 b)
+{
+    return ((b >> 4) * 10) + (b & 0x0F);
+}
+
+static inline __u8 safe_dec2bcd(__u8 d)
+{
+    return ((d / 10) << 4) | (d % 10);
+}
+
+// ---- 로터리: 방향 판별 / 디바운스 ----
+// S1 Falling 순간의 S2 레벨로 방향 결정 (High = +1, Low = -1)
+static inline int safe_rot_dir(int s2)
+{
+    return s2 ? 1 : -1;
+}
+
+// 마지막으로 인정한 칸에서 window(jiffies 등 단조 증가 단위) 이상 지났으면
+// 이번 에지를 인정하고 *last를 갱신. 카운터가 한 바퀴 돌아도 맞게 time_before와 같은 비교
+static inline int safe_rot_accept(unsigned long now, unsigned long *last, unsigned long window)
+{
+    if ((long)(now - (*last + window)) < 0)
+        return 0;
+    *last = now;
+    return 1;
+}
+
+// ---- OLED: 5x7 글자 -> 세로 바이트 열 ----
+#define SAFE_GLYPH_W 6   // 글자 5열 + 간격 1열
+
+// 글자 n개를 out에 n * SAFE_GLYPH_W 바이트로 풀어 씀 (128 이상 코드는 하위 7비트만 사용)
+static inline size_t safe_glyph_pack(const unsigned char font[][5], const char *s, size_t n, __u8 *out)
+{
+    const unsigned char *g;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        g = font[(unsigned char)s[i] & 0x7F];
+        out[0] = g[0]; out[1] = g[1]; out[2] = g[2]; out[3] = g[3]; out[4] = g[4];
+        out[5] = 0x00;
+        out += SAFE_GLYPH_W;
+    }
+    return n * SAFE_GLYPH_W;
+}
+
+// ---- 앱: 시간 설정 값 순환 (0~max_inclusive) ----
+static inline __u8 safe_wrap_add_u8(__u8 base, int delta, int max_inclusive)
+{
+    int v = (int)base + delta;
+    int mod = max_inclusive + 1;
+
+    // C의 음수 % 처리 때문에 안전하게 보정
+    v %= mod;
+    if (v < 0) v += mod;
+    return (__u8)v;
+}
+
+#endif
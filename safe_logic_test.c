@@ -0,0 +1,119 @@
+#include <kunit/test.h>
+#include <linux/module.h>
+#include <linux/string.h>
+
+#include "safe_logic.h"
+
+// safe_logic.h KUnit 테스트 (logic_bench의 결과 확인과 같은 내용 + 경계값)
+//   UML:    make kunit KUNIT_KDIR=<커널 소스>
+//   네이티브: make native && insmod safe_logic_test.ko (CONFIG_KUNIT 필요, 결과는 dmesg)
+
+static void bcd_roundtrip(struct kunit *test)
+{
+    int d;
+
+    for (d = 0; d < 100; d++) {
+        KUNIT_EXPECT_EQ(test, safe_dec2bcd(d), (d / 10) << 4 | d % 10);
+        KUNIT_EXPECT_EQ(test, safe_bcd2dec(safe_dec2bcd(d)), d);
+    }
+}
+
+static void bcd_registers(struct kunit *test)
+{
+    // DS1302 레지스터 값 그대로 (초 59, 시 23, 연도 99)
+    KUNIT_EXPECT_EQ(test, safe_bcd2dec(0x59), 59);
+    KUNIT_EXPECT_EQ(test, safe_bcd2dec(0x23), 23);
+    KUNIT_EXPECT_EQ(test, safe_bcd2dec(0x99), 99);
+    KUNIT_EXPECT_EQ(test, safe_bcd2dec(0x00), 0);
+    KUNIT_EXPECT_EQ(test, safe_dec2bcd(0), 0x00);
+}
+
+static void rot_dir(struct kunit *test)
+{
+    KUNIT_EXPECT_EQ(test, safe_rot_dir(1), 1);
+    KUNIT_EXPECT_EQ(test, safe_rot_dir(0), -1);
+    // gpio_get_value는 0/1 외의 값을 돌려줄 수도 있음
+    KUNIT_EXPECT_EQ(test, safe_rot_dir(4), 1);
+}
+
+static void rot_accept(struct kunit *test)
+{
+    unsigned long last = 0;
+
+    KUNIT_EXPECT_TRUE(test, safe_rot_accept(100, &last, 5));
+    KUNIT_EXPECT_EQ(test, last, 100UL);
+    // 창 안은 무시하고 last도 그대로
+    KUNIT_EXPECT_FALSE(test, safe_rot_accept(104, &last, 5));
+    KUNIT_EXPECT_EQ(test, last, 100UL);
+    // 창 끝(정확히 window 경과)부터 인정
+    KUNIT_EXPECT_TRUE(test, safe_rot_accept(105, &last, 5));
+    KUNIT_EXPECT_EQ(test, last, 105UL);
+    // window 0이면 같은 시각도 인정
+    KUNIT_EXPECT_TRUE(test, safe_rot_accept(105, &last, 0));
+}
+
+static void rot_accept_wrap(struct kunit *test)
+{
+    unsigned long last = ULONG_MAX - 2;
+
+    // jiffies가 한 바퀴 돌아도 경과 시간으로 판단
+    KUNIT_EXPECT_FALSE(test, safe_rot_accept(1, &last, 5));
+    KUNIT_EXPECT_TRUE(test, safe_rot_accept(2, &last, 5));
+    KUNIT_EXPECT_EQ(test, last, 2UL);
+}
+
+static void glyph_pack(struct kunit *test)
+{
+    static unsigned char font[128][5];
+    const char *s = "AB\xC1";   // 0xC1 -> 하위 7비트 'A'
+    u8 out[3 * SAFE_GLYPH_W];
+    int i, j;
+
+    for (i = 0; i < 128; i++)
+        for (j = 0; j < 5; j++)
+            font[i][j] = i * 5 + j + 1;
+
+    memset(out, 0xFF, sizeof(out));
+    KUNIT_EXPECT_EQ(test, safe_glyph_pack((const unsigned char (*)[5])font, s, 3, out),
+                    (size_t)3 * SAFE_GLYPH_W);
+    KUNIT_EXPECT_EQ(test, memcmp(out, font['A'], 5), 0);
+    KUNIT_EXPECT_EQ(test, out[5], 0);
+    KUNIT_EXPECT_EQ(test, memcmp(out + SAFE_GLYPH_W, font['B'], 5), 0);
+    KUNIT_EXPECT_EQ(test, out[SAFE_GLYPH_W + 5], 0);
+    KUNIT_EXPECT_EQ(test, memcmp(out + 2 * SAFE_GLYPH_W, font['A'], 5), 0);
+    // 0글자면 아무것도 쓰지 않음
+    KUNIT_EXPECT_EQ(test, safe_glyph_pack((const unsigned char (*)[5])font, s, 0, out), (size_t)0);
+}
+
+static void wrap_add_u8(struct kunit *test)
+{
+    KUNIT_EXPECT_EQ(test, safe_wrap_add_u8(23, 1, 23), 0);
+    KUNIT_EXPECT_EQ(test, safe_wrap_add_u8(0, -1, 59), 59);
+    KUNIT_EXPECT_EQ(test, safe_wrap_add_u8(10, -125, 59), 5);
+    KUNIT_EXPECT_EQ(test, safe_wrap_add_u8(58, 1, 59), 59);
+    KUNIT_EXPECT_EQ(test, safe_wrap_add_u8(5, 0, 9), 5);
+    // 로터리를 빠르게 돌려 한 번에 여러 바퀴 (시: 0~23)
+    KUNIT_EXPECT_EQ(test, safe_wrap_add_u8(20, 100, 23), (20 + 100) % 24);
+    KUNIT_EXPECT_EQ(test, safe_wrap_add_u8(3, -100, 23), 23);
+}
+
+static struct kunit_case safe_logic_cases[] = {
+    KUNIT_CASE(bcd_roundtrip),
+    KUNIT_CASE(bcd_registers),
+    KUNIT_CASE(rot_dir),
+    KUNIT_CASE(rot_accept),
+    KUNIT_CASE(rot_accept_wrap),
+    KUNIT_CASE(glyph_pack),
+    KUNIT_CASE(wrap_add_u8),
+    {}
+};
+
+static struct kunit_suite safe_logic_suite = {
+    .name = "safe_logic",
+    .test_cases = safe_logic_cases,
+};
+kunit_test_suite(safe_logic_suite);
+
+MODULE_LICENSE("GPL");
+MODULE_AUTHOR("kkk");
+MODULE_DESCRIPTION("KUnit tests for the hardware-independent logic in safe_logic.h");
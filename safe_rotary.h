@@ -0,0 +1,15 @@
+#ifndef SAFE_ROTARY_H
+#define SAFE_ROTARY_H
+
+#include <linux/notifier.h>
+
+// 로터리 이벤트 알림 (다른 모듈에서 구독, hardirq/타이머 또는 커널 스레드 문맥에서 호출됨, 잠들면 안 됨)
+enum {
+    SAFE_ROTARY_STEP,   // data = (long)+1 / -1
+    SAFE_ROTARY_BUTTON, // data = (long)1: Short, 2: Long
+};
+
+int safe_rotary_register_notifier(struct notifier_block *nb);
+int safe_rotary_unregister_notifier(struct notifier_block *nb);
+
+#endif
@@ -0,0 +1,776 @@
+// 장치 4개(로터리/부저/RTC/OLED)를 CUSE로 흉내 내는 시뮬레이터.
+// 라즈베리파이와 커널 모듈 없이 앱(main.c)을 그대로 돌려 보기 위한 용도.
+//
+//   make safe_sim   (libfuse3 개발 패키지 필요: libfuse3-dev / fuse3-devel)
+//   sudo ./safe_sim -s input.txt -o term -l sim.log &
+//   sudo SAFE_DEV_PREFIX=/dev/sim_ ./safe
+//
+// 장치 이름: /dev/<prefix>safe_rotary, safe_buzzer, ds1302, oled (기본 prefix "sim_")
+// 각 장치는 실제 드라이버와 같은 read/write/ioctl 규약을 따른다.
+//   로터리 : "값\n", "BTN_SHORT\n", "BTN_LONG\n" 텍스트, poll, O_NONBLOCK, 50ms 타임아웃
+//   부저   : int(ms, 0 이하 정지) 또는 buz_note 배열, 정책/통계/근접/WAIT ioctl
+//   RTC    : ds1302_time GET/SET ioctl (호스트 시계 + 오프셋)
+//   OLED   : 텍스트 write, OLED_CLEAR/OLED_SETPOS ioctl, 5x7 폰트로 128x64 화면 재현
+//
+// 입력 스크립트 (-s, 없으면 표준 입력에서 바로 실행):
+//   # 주석
+//   <직전 줄로부터 대기 ms> <cw|ccw|press|long|quit> [횟수]
+//   예) 500 press / 300 cw 5 / 1000 long / 2000 quit
+//
+// 화면 출력 (-o): term (터미널, 반 블록 문자), png:<디렉터리> (frame_00000.png ...), none
+// 타이밍 로그 (-l): "시작 후 ms  장치  내용" 한 줄씩
+//
+// 흉내 내지 않는 것: CUSE는 mmap을 지원하지 않으므로 로터리/RTC 상태 페이지가 없고,
+// /dev/safe_events도 만들지 않는다. 앱은 이때의 대체 경로로 돈다
+// (로터리 read + poll, RTC는 ioctl + rtc_tfd 확인, RTC 틱 없음). 상태 페이지와 이벤트
+// 스트림 경로는 실제 모듈(또는 gpio-sim/pwm_mock/oled_i2c_stub)로 확인해야 한다.
+#define FUSE_USE_VERSION 31
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <cuse_lowlevel.h>
+#include <fuse_lowlevel.h>
+
+// ===== 드라이버와 같은 정의 =====
+typedef struct { unsigned char x, page; } oled_pos_t;
+#define OLED_CLEAR  _IO('o', 0)
+#define OLED_SETPOS _IOW('o', 1, oled_pos_t)
+
+struct ds1302_time { unsigned char y, m, d, w, h, min, s; };
+#define RTC_GET _IOR('d', 0, struct ds1302_time)
+#define RTC_SET _IOW('d', 1, struct ds1302_time)
+
+struct buz_note {
+    unsigned short freq_hz;
+    unsigned char  duty_pct;
+    unsigned char  rsvd;
+    unsigned short dur_ms;
+    unsigned short gap_ms;
+};
+struct buz_policy { unsigned char prio, policy; unsigned short rsvd; };
+struct buz_stats { unsigned int depth, played, dropped, preempted; };
+struct buz_prox {
+    short target, value, min, max;
+    unsigned short range, base_ms, step_ms, beep_ms;
+};
+enum { BUZ_POLICY_QUEUE, BUZ_POLICY_PREEMPT, BUZ_POLICY_DROP_IF_BUSY };
+#define BUZ_IOC_WAIT       _IO('b', 0)
+#define BUZ_IOC_SET_POLICY _IOW('b', 1, struct buz_policy)
+#define BUZ_IOC_GET_STATS  _IOR('b', 2, struct buz_stats)
+#define BUZ_IOC_PROX_SET   _IOW('b', 3, struct buz_prox)
+#define BUZ_IOC_PROX_OFF   _IO('b', 4)
+#define BUZ_MAX_NOTES 64
+#define BUZ_QUEUE_LEN 8
+
+// ===== 공통 =====
+static const char *dev_prefix = "sim_";
+static const char *script_path;
+static const char *out_mode = "term";
+static int log_fd = -1;
+static long long t_start;
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void sleep_ms(long ms)
+{
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+// 한 줄을 write 한 번으로 (O_APPEND라 프로세스 4개가 같이 써도 섞이지 않음)
+static void simlog(const char *dev, const char *fmt, ...)
+{
+    char line[256];
+    va_list ap;
+    int n;
+
+    if (log_fd < 0) return;
+    n = snprintf(line, sizeof(line), "%10.3f %-6s ", (now_ns() - t_start) / 1e6, dev);
+    va_start(ap, fmt);
+    n += vsnprintf(line + n, sizeof(line) - n, fmt, ap);
+    va_end(ap);
+    if (n >= (int)sizeof(line) - 1) n = sizeof(line) - 2;
+    line[n++] = '\n';
+    write(log_fd, line, n);
+}
+
+static void sim_open(fuse_req_t req, struct fuse_file_info *fi)
+{
+    fuse_reply_open(req, fi);
+}
+
+// 제한 ioctl(CUSE 기본)에서는 커널이 _IOC 크기만큼 입력을 넘겨 줌
+#define IOC_ARG(type, dst) \
+    do { \
+        if (in_bufsz < sizeof(type)) { fuse_reply_err(req, EFAULT); return; } \
+        memcpy(dst, in_buf, sizeof(type)); \
+    } while (0)
+
+// ===== 로터리 =====
+static pthread_mutex_t rot_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t rot_cond = PTHREAD_COND_INITIALIZER;
+static long rot_value;
+static int rot_btn;       // 1: Short, 2: Long
+static int rot_ready;
+static struct fuse_pollhandle *rot_ph;
+
+static void rot_event(int step, int btn)
+{
+    pthread_mutex_lock(&rot_lock);
+    rot_value += step;
+    if (btn) rot_btn = btn;
+    rot_ready = 1;
+    pthread_cond_broadcast(&rot_cond);
+    if (rot_ph) {
+        fuse_lowlevel_notify_poll(rot_ph);
+        fuse_pollhandle_destroy(rot_ph);
+        rot_ph = NULL;
+    }
+    pthread_mutex_unlock(&rot_lock);
+
+    if (btn) simlog("rotary", "%s", btn == 2 ? "BTN_LONG" : "BTN_SHORT");
+    else simlog("rotary", "step %+d -> %ld", step, rot_value);
+}
+
+static void rot_read(fuse_req_t req, size_t size, off_t off, struct fuse_file_info *fi)
+{
+    char buf[32];
+    int len;
+
+    pthread_mutex_lock(&rot_lock);
+    if (!rot_ready) {
+        if (fi->flags & O_NONBLOCK) {
+            pthread_mutex_unlock(&rot_lock);
+            fuse_reply_err(req, EAGAIN);
+            return;
+        }
+        // 드라이버와 같은 50ms 타임아웃
+        struct timespec dl;
+        clock_gettime(CLOCK_REALTIME, &dl);
+        dl.tv_nsec += 50 * 1000000L;
+        if (dl.tv_nsec >= 1000000000L) { dl.tv_sec++; dl.tv_nsec -= 1000000000L; }
+        while (!rot_ready && pthread_cond_timedwait(&rot_cond, &rot_lock, &dl) != ETIMEDOUT)
+            ;
+        if (!rot_ready) {
+            pthread_mutex_unlock(&rot_lock);
+            fuse_reply_buf(req, NULL, 0);
+            return;
+        }
+    }
+
+    rot_ready = 0;
+    if (rot_btn == 2) len = snprintf(buf, sizeof(buf), "BTN_LONG\n");
+    else if (rot_btn == 1) len = snprintf(buf, sizeof(buf), "BTN_SHORT\n");
+    else len = snprintf(buf, sizeof(buf), "%ld\n", rot_value);
+    rot_btn = 0;
+    pthread_mutex_unlock(&rot_lock);
+
+    fuse_reply_buf(req, buf, (size_t)len < size ? (size_t)len : size);
+}
+
+static void rot_poll(fuse_req_t req, struct fuse_file_info *fi, struct fuse_pollhandle *ph)
+{
+    unsigned revents;
+
+    pthread_mutex_lock(&rot_lock);
+    if (rot_ph) fuse_pollhandle_destroy(rot_ph);
+    rot_ph = ph;
+    revents = rot_ready ? (POLLIN | POLLRDNORM) : 0;
+    pthread_mutex_unlock(&rot_lock);
+    fuse_reply_poll(req, revents);
+}
+
+static int script_cmd(const char *cmd, int count)
+{
+    if (!strcmp(cmd, "quit")) {
+        simlog("script", "quit");
+        kill(0, SIGTERM);
+        return -1;
+    }
+    for (int i = 0; i < (count > 0 ? count : 1); i++) {
+        if (!strcmp(cmd, "cw")) rot_event(+1, 0);
+        else if (!strcmp(cmd, "ccw")) rot_event(-1, 0);
+        else if (!strcmp(cmd, "press")) rot_event(0, 1);
+        else if (!strcmp(cmd, "long")) rot_event(0, 2);
+        else {
+            fprintf(stderr, "safe_sim: unknown command '%s'\n", cmd);
+            return 0;
+        }
+        // 연속 입력은 드라이버 디바운스(50ms)보다 넓게
+        if (count > 1) sleep_ms(60);
+    }
+    return 0;
+}
+
+// 스크립트가 있으면 "대기ms 명령 [횟수]", 없으면 표준 입력에서 "명령 [횟수]"
+static void *script_thread(void *arg)
+{
+    FILE *fp = script_path ? fopen(script_path, "r") : stdin;
+    char line[128], cmd[32];
+    long delay;
+    int count;
+
+    (void)arg;
+    if (!fp) { perror(script_path); return NULL; }
+    while (fgets(line, sizeof(line), fp)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        count = 1;
+        if (script_path) {
+            if (sscanf(line, "%ld %31s %d", &delay, cmd, &count) < 2) continue;
+            sleep_ms(delay);
+        } else {
+            if (sscanf(line, "%31s %d", cmd, &count) < 1) continue;
+        }
+        if (script_cmd(cmd, count) < 0) break;
+    }
+    return NULL;
+}
+
+static const struct cuse_lowlevel_ops rot_ops = {
+    .open = sim_open,
+    .read = rot_read,
+    .poll = rot_poll,
+};
+
+// ===== 부저 =====
+// 드라이버 스케줄러와 같은 규칙 (우선순위 큐 8칸, 정책은 fd별). 실제 소리 대신 로그만 남김
+struct sim_req { int prio; long long dur_ns; };
+
+static pthread_mutex_t buz_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t buz_cond = PTHREAD_COND_INITIALIZER;
+static int buz_playing, buz_prio;
+static long long buz_end;
+static struct sim_req buz_queue[BUZ_QUEUE_LEN];
+static int buz_qlen;
+static struct buz_stats buz_st;
+
+// 시간이 지난 재생을 끝내고 큐에서 다음 요청을 꺼냄 (buz_lock 잡은 상태)
+static void buz_advance(void)
+{
+    long long now = now_ns();
+
+    while (buz_playing && now >= buz_end) {
+        buz_st.played++;
+        if (buz_qlen == 0) {
+            buz_playing = 0;
+            pthread_cond_broadcast(&buz_cond);
+            break;
+        }
+        buz_prio = buz_queue[0].prio;
+        buz_end += buz_queue[0].dur_ns;
+        memmove(&buz_queue[0], &buz_queue[1], --buz_qlen * sizeof(buz_queue[0]));
+    }
+}
+
+static void buz_start(int prio, long long dur)
+{
+    buz_playing = 1;
+    buz_prio = prio;
+    buz_end = now_ns() + dur;
+}
+
+static int buz_submit(const struct buz_policy *p, long long dur)
+{
+    int pos;
+
+    buz_advance();
+    if (!buz_playing) {
+        buz_start(p->prio, dur);
+        return 0;
+    }
+    if (p->policy == BUZ_POLICY_DROP_IF_BUSY) {
+        buz_st.dropped++;
+        return -EBUSY;
+    }
+    if (p->policy == BUZ_POLICY_PREEMPT && p->prio >= buz_prio) {
+        buz_st.preempted++;
+        buz_start(p->prio, dur);
+        return 0;
+    }
+    if (buz_qlen == BUZ_QUEUE_LEN) {
+        buz_st.dropped++;
+        if (buz_queue[buz_qlen - 1].prio >= p->prio) return -EBUSY;
+        buz_qlen--;
+    }
+    for (pos = 0; pos < buz_qlen && buz_queue[pos].prio >= p->prio; pos++)
+        ;
+    memmove(&buz_queue[pos + 1], &buz_queue[pos], (buz_qlen - pos) * sizeof(buz_queue[0]));
+    buz_queue[pos].prio = p->prio;
+    buz_queue[pos].dur_ns = dur;
+    buz_qlen++;
+    return 0;
+}
+
+static void buz_open(fuse_req_t req, struct fuse_file_info *fi)
+{
+    struct buz_policy *p = calloc(1, sizeof(*p));
+
+    if (!p) { fuse_reply_err(req, ENOMEM); return; }
+    p->policy = BUZ_POLICY_PREEMPT;
+    fi->fh = (uintptr_t)p;
+    fuse_reply_open(req, fi);
+}
+
+static void buz_release(fuse_req_t req, struct fuse_file_info *fi)
+{
+    free((void *)(uintptr_t)fi->fh);
+    fuse_reply_err(req, 0);
+}
+
+static void buz_write(fuse_req_t req, const char *buf, size_t size, off_t off,
+                      struct fuse_file_info *fi)
+{
+    struct buz_policy *p = (void *)(uintptr_t)fi->fh;
+    long long dur = 0;
+    int ret;
+
+    if (size == sizeof(int)) {
+        int ms;
+
+        memcpy(&ms, buf, sizeof(int));
+        pthread_mutex_lock(&buz_lock);
+        if (ms <= 0) {
+            buz_playing = 0;
+            buz_qlen = 0;
+            pthread_cond_broadcast(&buz_cond);
+            pthread_mutex_unlock(&buz_lock);
+            simlog("buzzer", "stop");
+            fuse_reply_write(req, size);
+            return;
+        }
+        ret = buz_submit(p, ms * 1000000LL);
+        pthread_mutex_unlock(&buz_lock);
+        simlog("buzzer", "beep %dms prio=%d policy=%d%s", ms, p->prio, p->policy,
+               ret ? " (dropped)" : "");
+    } else {
+        const struct buz_note *n = (const void *)buf;
+        size_t cnt = size / sizeof(*n);
+
+        if (size == 0 || size % sizeof(*n) || cnt > BUZ_MAX_NOTES) {
+            fuse_reply_err(req, EINVAL);
+            return;
+        }
+        for (size_t i = 0; i < cnt; i++) dur += (n[i].dur_ms + n[i].gap_ms) * 1000000LL;
+        pthread_mutex_lock(&buz_lock);
+        ret = buz_submit(p, dur);
+        pthread_mutex_unlock(&buz_lock);
+        simlog("buzzer", "seq %zu notes %lldms first=%uHz prio=%d policy=%d%s", cnt,
+               dur / 1000000, n[0].freq_hz, p->prio, p->policy, ret ? " (dropped)" : "");
+    }
+
+    if (ret) fuse_reply_err(req, -ret);
+    else fuse_reply_write(req, size);
+}
+
+static void buz_ioctl(fuse_req_t req, int cmd, void *arg, struct fuse_file_info *fi,
+                      unsigned flags, const void *in_buf, size_t in_bufsz, size_t out_bufsz)
+{
+    struct buz_policy *p = (void *)(uintptr_t)fi->fh;
+    struct buz_stats st;
+    struct buz_prox pr;
+    struct buz_policy np;
+
+    switch ((unsigned)cmd) {
+    case BUZ_IOC_WAIT:
+        pthread_mutex_lock(&buz_lock);
+        for (;;) {
+            buz_advance();
+            if (!buz_playing) break;
+            pthread_mutex_unlock(&buz_lock);
+            sleep_ms(1);
+            pthread_mutex_lock(&buz_lock);
+        }
+        pthread_mutex_unlock(&buz_lock);
+        fuse_reply_ioctl(req, 0, NULL, 0);
+        break;
+    case BUZ_IOC_SET_POLICY:
+        IOC_ARG(struct buz_policy, &np);
+        if (np.policy > BUZ_POLICY_DROP_IF_BUSY) { fuse_reply_err(req, EINVAL); return; }
+        *p = np;
+        fuse_reply_ioctl(req, 0, NULL, 0);
+        break;
+    case BUZ_IOC_GET_STATS:
+        pthread_mutex_lock(&buz_lock);
+        buz_advance();
+        st = buz_st;
+        st.depth = buz_qlen;
+        pthread_mutex_unlock(&buz_lock);
+        fuse_reply_ioctl(req, 0, &st, sizeof(st));
+        break;
+    case BUZ_IOC_PROX_SET:
+        // 근접 비프는 실제로는 로터리 통지로 커널이 만든다. 시뮬레이터에선 설정만 기록
+        IOC_ARG(struct buz_prox, &pr);
+        simlog("buzzer", "prox target=%d value=%d", pr.target, pr.value);
+        fuse_reply_ioctl(req, 0, NULL, 0);
+        break;
+    case BUZ_IOC_PROX_OFF:
+        simlog("buzzer", "prox off");
+        fuse_reply_ioctl(req, 0, NULL, 0);
+        break;
+    default:
+        fuse_reply_err(req, ENOTTY);
+    }
+}
+
+static const struct cuse_lowlevel_ops buz_ops = {
+    .open    = buz_open,
+    .release = buz_release,
+    .write   = buz_write,
+    .ioctl   = buz_ioctl,
+};
+
+// ===== RTC =====
+// 호스트 시계에 RTC_SET으로 생긴 차이(초)를 더해 돌려줌
+static time_t rtc_offset;
+
+static void rtc_ioctl(fuse_req_t req, int cmd, void *arg, struct fuse_file_info *fi,
+                      unsigned flags, const void *in_buf, size_t in_bufsz, size_t out_bufsz)
+{
+    struct ds1302_time t;
+    struct tm tm;
+    time_t now = time(NULL);
+
+    switch ((unsigned)cmd) {
+    case RTC_GET:
+        now += rtc_offset;
+        localtime_r(&now, &tm);
+        t.y = tm.tm_year % 100;
+        t.m = tm.tm_mon + 1;
+        t.d = tm.tm_mday;
+        t.w = tm.tm_wday + 1;
+        t.h = tm.tm_hour;
+        t.min = tm.tm_min;
+        t.s = tm.tm_sec;
+        fuse_reply_ioctl(req, 0, &t, sizeof(t));
+        break;
+    case RTC_SET:
+        IOC_ARG(struct ds1302_time, &t);
+        memset(&tm, 0, sizeof(tm));
+        tm.tm_year = 100 + t.y;
+        tm.tm_mon = t.m ? t.m - 1 : 0;
+        tm.tm_mday = t.d ? t.d : 1;
+        tm.tm_hour = t.h;
+        tm.tm_min = t.min;
+        tm.tm_sec = t.s;
+        tm.tm_isdst = -1;
+        rtc_offset = mktime(&tm) - now;
+        simlog("rtc", "set %02d:%02d:%02d", t.h, t.min, t.s);
+        fuse_reply_ioctl(req, 0, NULL, 0);
+        break;
+    default:
+        fuse_reply_err(req, ENOTTY);
+    }
+}
+
+static const struct cuse_lowlevel_ops rtc_ops = {
+    .open  = sim_open,
+    .ioctl = rtc_ioctl,
+};
+
+// ===== OLED =====
+static const unsigned char font5x7[128][5] = {
+    [0x20]={0},
+    ['0']={0x3E,0x51,0x49,0x45,0x3E}, ['1']={0,0x42,0x7F,0x40,0},
+    ['2']={0x42,0x61,0x51,0x49,0x46}, ['3']={0x21,0x41,0x45,0x4B,0x31},
+    ['4']={0x18,0x14,0x12,0x7F,0x10}, ['5']={0x27,0x45,0x45,0x45,0x39},
+    ['6']={0x3C,0x4A,0x49,0x49,0x30}, ['7']={0x01,0x71,0x09,0x05,0x03},
+    ['8']={0x36,0x49,0x49,0x49,0x36}, ['9']={0x06,0x49,0x49,0x29,0x1E},
+    [':']={0,0x36,0x36,0,0}, ['>']={0,0x41,0x3E,0x1C,0},
+    ['A']={0x7E,0x09,0x09,0x09,0x7E}, ['B']={0x7F,0x49,0x49,0x49,0x36},
+    ['C']={0x3E,0x41,0x41,0x41,0x22}, ['D']={0x7F,0x41,0x41,0x22,0x1C},
+    ['E']={0x7F,0x49,0x49,0x49,0},     ['F']={0x7F,0x09,0x09,0x01,0},
+    ['G']={0x3E,0x41,0x49,0x49,0x7A}, ['H']={0x7F,0x08,0x08,0x08,0x7F},
+    ['I']={0,0x41,0x7F,0x41,0},       ['K']={0x7F,0x08,0x14,0x22,0x41},
+    ['L']={0x7F,0x40,0x40,0x40,0},     ['M']={0x7F,0x02,0x04,0x02,0x7F},
+    ['N']={0x7F,0x02,0x04,0x08,0x7F}, ['O']={0x3E,0x41,0x41,0x41,0x3E},
+    ['P']={0x7F,0x09,0x09,0x09,0x06}, ['R']={0x7F,0x09,0x19,0x29,0x46},
+    ['S']={0x46,0x49,0x49,0x49,0x31}, ['T']={0x01,0x01,0x7F,0x01,0x01},
+    ['U']={0x3F,0x40,0x40,0x40,0x3F}, ['V']={0x1F,0x20,0x40,0x20,0x1F},
+    ['Y']={0x01,0x02,0x7C,0x02,0x01}, ['W']={0x3F,0x40,0x38,0x40,0x3F},
+    ['*']={0x14,0x08,0x3E,0x08,0x14}, ['!']={0,0,0x5F,0,0}, ['-']={8,8,8,8,8},
+    ['[']={0x7F,0x41,0x41,0,0},       [']']={0,0,0x41,0x41,0x7F}
+};
+
+static pthread_mutex_t oled_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned char fb[8][128];   // SSD1306 GDDRAM과 같은 배치 (page x column, LSB가 위)
+static int oled_x, oled_page, oled_dirty = 1;
+
+static void oled_put(unsigned char col)
+{
+    fb[oled_page][oled_x] = col;
+    // 가로 주소 모드: 끝 열 다음은 다음 페이지 처음
+    if (++oled_x > 127) {
+        oled_x = 0;
+        oled_page = (oled_page + 1) & 7;
+    }
+}
+
+static void oled_write(fuse_req_t req, const char *buf, size_t size, off_t off,
+                       struct fuse_file_info *fi)
+{
+    size_t n = size < 127 ? size : 127;
+
+    pthread_mutex_lock(&oled_lock);
+    simlog("oled", "write p%d x%d \"%.*s\"", oled_page, oled_x, (int)n, buf);
+    for (size_t i = 0; i < n && buf[i]; i++) {
+        const unsigned char *g = font5x7[buf[i] & 0x7F];
+        for (int j = 0; j < 5; j++) oled_put(g[j]);
+        oled_put(0);
+    }
+    oled_dirty = 1;
+    pthread_mutex_unlock(&oled_lock);
+    fuse_reply_write(req, size);
+}
+
+static void oled_ioctl(fuse_req_t req, int cmd, void *arg, struct fuse_file_info *fi,
+                       unsigned flags, const void *in_buf, size_t in_bufsz, size_t out_bufsz)
+{
+    oled_pos_t pos;
+
+    switch ((unsigned)cmd) {
+    case OLED_CLEAR:
+        pthread_mutex_lock(&oled_lock);
+        memset(fb, 0, sizeof(fb));
+        oled_x = oled_page = 0;
+        oled_dirty = 1;
+        pthread_mutex_unlock(&oled_lock);
+        simlog("oled", "clear");
+        fuse_reply_ioctl(req, 0, NULL, 0);
+        break;
+    case OLED_SETPOS:
+        IOC_ARG(oled_pos_t, &pos);
+        pthread_mutex_lock(&oled_lock);
+        oled_x = pos.x > 127 ? 127 : pos.x;
+        oled_page = pos.page > 7 ? 7 : pos.page;
+        pthread_mutex_unlock(&oled_lock);
+        fuse_reply_ioctl(req, 0, NULL, 0);
+        break;
+    default:
+        fuse_reply_err(req, ENOTTY);
+    }
+}
+
+static inline int px(int x, int y)
+{
+    return (fb[y >> 3][x] >> (y & 7)) & 1;
+}
+
+// 터미널: 세로 2픽셀을 반 블록 문자 하나로 (128 x 32 칸)
+static void render_term(void)
+{
+    static const char *cell[4] = { " ", "▀", "▄", "█" };
+    char out[128 * 32 * 3 + 32 * 2 + 16];
+    int n = 0;
+
+    n += sprintf(out + n, "\033[H");
+    for (int y = 0; y < 64; y += 2) {
+        for (int x = 0; x < 128; x++) {
+            const char *c = cell[px(x, y) | (px(x, y + 1) << 1)];
+            size_t l = strlen(c);
+            memcpy(out + n, c, l);
+            n += l;
+        }
+        out[n++] = '\n';
+    }
+    fwrite(out, 1, n, stdout);
+    fflush(stdout);
+}
+
+// PNG: 8비트 흑백, 2배 확대, 무압축(stored) deflate
+static uint32_t crc_table[256];
+
+static void crc_init(void)
+{
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        crc_table[i] = c;
+    }
+}
+
+static uint32_t crc_update(uint32_t c, const unsigned char *p, size_t n)
+{
+    while (n--) c = crc_table[(c ^ *p++) & 0xFF] ^ (c >> 8);
+    return c;
+}
+
+static void put_be32(unsigned char *p, uint32_t v)
+{
+    p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+static void png_chunk(FILE *fp, const char *type, const unsigned char *data, uint32_t len)
+{
+    unsigned char hdr[8], tail[4];
+    uint32_t crc;
+
+    put_be32(hdr, len);
+    memcpy(hdr + 4, type, 4);
+    crc = crc_update(0xFFFFFFFFu, hdr + 4, 4);
+    crc = crc_update(crc, data, len);
+    put_be32(tail, crc ^ 0xFFFFFFFFu);
+    fwrite(hdr, 1, 8, fp);
+    fwrite(data, 1, len, fp);
+    fwrite(tail, 1, 4, fp);
+}
+
+#define PNG_SCALE 2
+#define PNG_W (128 * PNG_SCALE)
+#define PNG_H (64 * PNG_SCALE)
+
+static void render_png(const char *dir, int frame)
+{
+    static unsigned char raw[PNG_H * (PNG_W + 1)];
+    static unsigned char z[2 + sizeof(raw) + (sizeof(raw) / 65535 + 1) * 5 + 4];
+    static const unsigned char sig[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    unsigned char ihdr[13] = { 0 };
+    char path[256];
+    uint32_t a = 1, b = 0;
+    size_t zn = 0, left, pos = 0;
+    FILE *fp;
+
+    for (int y = 0; y < PNG_H; y++) {
+        unsigned char *row = raw + y * (PNG_W + 1);
+        row[0] = 0;   // filter: none
+        for (int x = 0; x < PNG_W; x++)
+            row[1 + x] = px(x / PNG_SCALE, y / PNG_SCALE) ? 0xFF : 0x00;
+    }
+
+    // zlib: 헤더 + stored 블록들 + adler32
+    z[zn++] = 0x78;
+    z[zn++] = 0x01;
+    for (left = sizeof(raw); left > 0; ) {
+        uint16_t len = left > 65535 ? 65535 : left;
+        z[zn++] = (left == len);
+        z[zn++] = len & 0xFF; z[zn++] = len >> 8;
+        z[zn++] = ~len & 0xFF; z[zn++] = (~len >> 8) & 0xFF;
+        memcpy(z + zn, raw + pos, len);
+        zn += len; pos += len; left -= len;
+    }
+    for (size_t i = 0; i < sizeof(raw); i++) {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    put_be32(z + zn, (b << 16) | a);
+    zn += 4;
+
+    put_be32(ihdr, PNG_W);
+    put_be32(ihdr + 4, PNG_H);
+    ihdr[8] = 8;   // bit depth
+    ihdr[9] = 0;   // grayscale
+
+    snprintf(path, sizeof(path), "%s/frame_%05d.png", dir, frame);
+    fp = fopen(path, "wb");
+    if (!fp) { perror(path); return; }
+    fwrite(sig, 1, sizeof(sig), fp);
+    png_chunk(fp, "IHDR", ihdr, sizeof(ihdr));
+    png_chunk(fp, "IDAT", z, zn);
+    png_chunk(fp, "IEND", NULL, 0);
+    fclose(fp);
+    simlog("oled", "frame %d -> %s", frame, path);
+}
+
+// 바뀐 화면을 최대 20fps로 출력
+static void *render_thread(void *arg)
+{
+    int frame = 0;
+
+    (void)arg;
+    if (!strcmp(out_mode, "term")) printf("\033[2J");
+    else if (!strncmp(out_mode, "png:", 4)) crc_init();
+
+    while (1) {
+        sleep_ms(50);
+        pthread_mutex_lock(&oled_lock);
+        if (oled_dirty) {
+            oled_dirty = 0;
+            if (!strcmp(out_mode, "term")) render_term();
+            else if (!strncmp(out_mode, "png:", 4)) render_png(out_mode + 4, frame++);
+        }
+        pthread_mutex_unlock(&oled_lock);
+    }
+    return NULL;
+}
+
+static const struct cuse_lowlevel_ops oled_ops = {
+    .open  = sim_open,
+    .write = oled_write,
+    .ioctl = oled_ioctl,
+};
+
+// ===== 실행 =====
+// 장치마다 프로세스 하나 (CUSE 세션은 프로세스당 하나가 단순함)
+static pid_t run_dev(const char *name, const struct cuse_lowlevel_ops *ops,
+                     void *(*helper)(void *))
+{
+    char devname[96];
+    const char *dev_info[] = { devname };
+    char *argv[] = { "safe_sim", "-f", NULL };
+    struct cuse_info ci = {
+        .dev_info_argc = 1,
+        .dev_info_argv = dev_info,
+    };
+    pthread_t th;
+    pid_t pid = fork();
+
+    if (pid != 0) return pid;
+
+    snprintf(devname, sizeof(devname), "DEVNAME=%s%s", dev_prefix, name);
+    if (helper) pthread_create(&th, NULL, helper, NULL);
+    exit(cuse_lowlevel_main(2, argv, &ci, ops, NULL));
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-s script] [-o term|png:DIR|none] [-l logfile] [-P prefix]\n", prog);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    pid_t pids[4];
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:o:l:P:")) != -1) {
+        if (opt == 's') script_path = optarg;
+        else if (opt == 'o') out_mode = optarg;
+        else if (opt == 'l') {
+            log_fd = open(optarg, O_WRONLY | O_CREAT | O_APPEND | O_TRUNC, 0644);
+            if (log_fd < 0) { perror(optarg); return 1; }
+        }
+        else if (opt == 'P') dev_prefix = optarg;
+        else usage(argv[0]);
+    }
+
+    t_start = now_ns();
+    setpgid(0, 0);   // quit 명령이 kill(0)으로 전부 끝낼 수 있게
+
+    pids[0] = run_dev("safe_rotary", &rot_ops, script_thread);
+    pids[1] = run_dev("safe_buzzer", &buz_ops, NULL);
+    pids[2] = run_dev("ds1302", &rtc_ops, NULL);
+    pids[3] = run_dev("oled", &oled_ops, render_thread);
+
+    // 하나라도 끝나면 나머지도 정리
+    wait(NULL);
+    for (int i = 0; i < 4; i++) kill(pids[i], SIGTERM);
+    while (wait(NULL) > 0)
+        ;
+    return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef SAFE_STATUS_H
+#define SAFE_STATUS_H
+
+#include <linux/types.h>
+
+// mmap으로 읽는 상태 페이지 (읽기 전용, 드라이버와 앱이 같이 사용)
+//   /dev/safe_rotary -> struct safe_rotary_status
+//   /dev/ds1302      -> struct safe_rtc_status (매핑돼 있는 동안만 주기적으로 갱신)
+//
+// seqlock: 드라이버는 seq를 홀수로 올리고 내용을 바꾼 뒤 다시 짝수로 올린다.
+// 앱은 seq가 짝수이고, 복사 전후 값이 같을 때만 읽은 내용을 쓴다.
+
+struct safe_rotary_status {
+    __u32 seq;
+    __s32 value;      // 로터리 위치 (read()로 받는 값과 같음)
+    __u32 btn;        // 마지막 버튼 이벤트 (1: Short, 2: Long)
+    __u32 btn_count;  // 버튼 이벤트 누적 수
+    __u32 events;     // 회전 + 버튼 이벤트 누적 수
+    __u32 rsvd;
+    __u64 ts_ns;      // 마지막 이벤트 시각 (CLOCK_MONOTONIC)
+};
+
+struct safe_rtc_status {
+    __u32 seq;
+    __u32 valid;      // 한 번이라도 읽기에 성공했으면 1
+    __u8  year, month, date, dow, hour, min, sec, rsvd;
+    __u64 ts_ns;      // 마지막으로 DS1302를 읽은 시각 (CLOCK_MONOTONIC)
+};
+
+#endif